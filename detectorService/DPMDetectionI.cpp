@@ -36,8 +36,13 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  *****************************************************************************/
 #include "DPMDetectionI.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
 #include <iostream>
 #include <vector>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
 
 #include <Ice/Communicator.h>
 #include <Ice/Initialize.h>
@@ -71,7 +76,7 @@ extern "C"
 ///////////////////////////////////////////////////////////////////////////////
 
 DPMDetectionI::DPMDetectionI()
-  :fInitialized(false),filepathDefaultModel("")
+  :filepathDefaultModel("")
 {
   mServiceMan = NULL;
 }
@@ -106,9 +111,15 @@ void DPMDetectionI::stopping()
 {
 }
 
+/** acquire the model of the request from the shared registry into the
+ *  lease of the configured precision (DPM.Precision), leaving the other
+ *  empty. The caller's lease keeps the detector alive while it is in use
+ */
 bool DPMDetectionI::initialize(cvac::DetectorDataArchive* _dda,
                                const ::cvac::FilePath &file,
-                               const::Ice::Current &current)
+                               const::Ice::Current &current,
+                               ModelRegistry<float>::Lease& _modelFloat,
+                               ModelRegistry<double>::Lease& _modelDouble)
 {
   // Set CVAC verbosity according to ICE properties
   Ice::PropertiesPtr props = (current.adapter->getCommunicator()->getProperties());
@@ -132,6 +143,44 @@ bool DPMDetectionI::initialize(cvac::DetectorDataArchive* _dda,
     else
       zipfilepath = m_CVAC_DataDir + "/" + filepathDefaultModel;
   } 
+
+  // DPM.Precision selects the detector precision. float halves the memory
+  // traffic of every stage; use the PrecisionCheck harness to confirm a
+  // model detects the same objects in both before relying on it
+  string precision = props->getPropertyWithDefault("DPM.Precision", "float");
+  if (precision != "float" && precision != "double")
+    localAndClientMsg(VLogger::WARN, NULL,
+      "Unknown DPM.Precision \"%s\", using float\n", precision.c_str());
+  bool useFloat = (precision != "double");
+
+  // size the shared model registry from the service config
+  int registryMB = props->getPropertyAsIntWithDefault("DPM.ModelRegistryMB", 512);
+  int registryEntries = props->getPropertyAsIntWithDefault("DPM.ModelRegistryEntries", 8);
+
+  // reuse the detector if this archive was loaded before
+  _modelFloat = ModelRegistry<float>::Lease();
+  _modelDouble = ModelRegistry<double>::Lease();
+  if (useFloat)
+  {
+    ModelRegistry<float>::instance().setCapacity((size_t)registryMB*1024*1024, registryEntries);
+    _modelFloat = ModelRegistry<float>::instance().acquire(zipfilepath,
+      boost::bind(&DPMDetectionI::loadDetector<float>, this, _dda, clientDir, _1));
+    return !_modelFloat.empty();
+  }
+  ModelRegistry<double>::instance().setCapacity((size_t)registryMB*1024*1024, registryEntries);
+  _modelDouble = ModelRegistry<double>::instance().acquire(zipfilepath,
+    boost::bind(&DPMDetectionI::loadDetector<double>, this, _dda, clientDir, _1));
+  return !_modelDouble.empty();
+}
+
+/** unarchive, deserialize and distribute a trained model,
+ *  returning an empty pointer on failure
+ */
+template<typename T>
+typename ModelRegistry<T>::DetectorPtr DPMDetectionI::loadDetector(cvac::DetectorDataArchive* _dda,
+                                                                  const std::string& clientDir,
+                                                                  const std::string& zipfilepath)
+{
   _dda->unarchive(zipfilepath, clientDir);
 
   string modelXML = _dda->getFile( XMLID );
@@ -139,35 +188,38 @@ bool DPMDetectionI::initialize(cvac::DetectorDataArchive* _dda,
   {
       localAndClientMsg(VLogger::ERROR, NULL,
                         "Could not find XML result file in the zip file.\n");
-      fInitialized = false;
-      return false;
+      return typename ModelRegistry<T>::DetectorPtr();
   }
   // Get only the filename part
   //modelXML = getFileName(modelXML);  TODO: why???  it doesn't work without the path. matz.  
   boost::scoped_ptr<Model> fsmodel;   
-  fsmodel.reset(new FileStorageModel);                
+  // binary (.dpm) models are mapped rather than parsed, which is much faster
+  // for large mixture models
+  if (boost::filesystem::path(modelXML).extension().string() == ".dpm")
+    fsmodel.reset(new BinaryModel);
+  else
+    fsmodel.reset(new FileStorageModel);                
   if(!fsmodel->deserialize( modelXML )) 
   {
       localAndClientMsg(VLogger::ERROR, NULL, 
         "Failed to initialize because the file %s has a problem\n",
         modelXML.c_str());
-      fInitialized = false;
-      return false;
+      return typename ModelRegistry<T>::DetectorPtr();
   }
 
-  pbd.distributeModel(*fsmodel);
-  fInitialized = true;
-  return true;
-}
-
-bool DPMDetectionI::isInitialized()
-{
-  return fInitialized;
+  // keep the engine-ready filter bank next to the unarchived model so that
+  // later starts with the same model skip preparing it. The bank is
+  // precision specific, so each precision keeps its own
+  typename ModelRegistry<T>::DetectorPtr pbd(new typename ModelRegistry<T>::Detector);
+  const std::string cacheFile = modelXML + (sizeof(T) == sizeof(float) ? ".f32.fbc" : ".f64.fbc");
+  if (pbd->distributeModel(*fsmodel, 1.0f, cacheFile))
+    localAndClientMsg(VLogger::DEBUG, NULL, "Read filter bank from %s\n", cacheFile.c_str());
+  return pbd;
 }
 
 void DPMDetectionI::destroy(const ::Ice::Current& current)
 {
-  fInitialized = false;
+  // models are leased per request and released when it completes
 }
 
 std::string DPMDetectionI::getName(const ::Ice::Current& curren)
@@ -205,10 +257,12 @@ void DPMDetectionI::process(const Ice::Identity &client,
   DetectorCallbackHandlerPrx callback = 
     DetectorCallbackHandlerPrx::uncheckedCast(current.con->createProxy(client)->ice_oneway());
 
+  // the leases pin the detector for the whole request, even if the
+  // registry evicts it or another request overlaps this one
   DetectorDataArchive dda;
-  initialize(&dda, trainedModelFile, current);
-
-  if(!isInitialized())
+  ModelRegistry<float>::Lease modelFloat;
+  ModelRegistry<double>::Lease modelDouble;
+  if(!initialize(&dda, trainedModelFile, current, modelFloat, modelDouble))
   {
     localAndClientMsg(VLogger::ERROR, callback, "DPMDetectionI not initialized, aborting.\n");
   }
@@ -254,34 +308,286 @@ void DPMDetectionI::process(const Ice::Identity &client,
   } 
   // End - RunsetIterator
 
+  if (!modelDouble.empty())
+    detectRunSet<double>(modelDouble, mRunsetIterator, callback, current);
+  else
+    detectRunSet<float>(modelFloat, mRunsetIterator, callback, current);
+}
+
+/** detect in every image of the RunSet with the leased detector of
+ *  precision T (empty if no model is loaded), reporting the results to
+ *  _callback. The caller keeps the lease until this returns
+ */
+template<typename T>
+void DPMDetectionI::detectRunSet(const typename ModelRegistry<T>::Lease& _model,
+                                 cvac::RunSetIterator& _it,
+                                 cvac::DetectorCallbackHandlerPrx _callback,
+                                 const ::Ice::Current& current)
+{
+  // run the RunSet through three stages connected by bounded queues:
+  //  - a decoder thread reading the images of the RunSet ahead
+  //  - detection on a pool of workers, each with its own context on the
+  //    shared model, dispatched from this thread in RunSet order
+  //  - a reporter thread adding results in that same order
+  // DPM.NumWorkers sets the pool size (0 for one per hardware thread) and
+  // DPM.PrefetchImages how many decoded images may wait for a worker.
+  // DPM.MinObjectSize and DPM.MaxObjectSize (pixels, 0 for no limit) restrict
+  // the search, and let large minimum sizes read JPEGs at reduced resolution.
+  // DPM.StreamBatchSize (results) and DPM.StreamIntervalMs stream results to
+  // the client as images complete; with both 0 they are sent once at the end.
+  // Each result carries the stage costs of its detection, and images slower
+  // than DPM.SlowImageMs (0 to disable) are logged with them
+  Ice::PropertiesPtr iceProps = current.adapter->getCommunicator()->getProperties();
+  int nWorkers = iceProps->getPropertyAsIntWithDefault("DPM.NumWorkers", 0);
+  if (nWorkers <= 0)
+    nWorkers = std::max(boost::thread::hardware_concurrency(), 1u);
+  int nPrefetch = iceProps->getPropertyAsIntWithDefault("DPM.PrefetchImages", nWorkers);
+  int minObjectSize = iceProps->getPropertyAsIntWithDefault("DPM.MinObjectSize", 0);
+  int maxObjectSize = iceProps->getPropertyAsIntWithDefault("DPM.MaxObjectSize", 0);
+  int slowImageMs = iceProps->getPropertyAsIntWithDefault("DPM.SlowImageMs", 0);
+  ResultStream stream(_callback,
+    iceProps->getPropertyAsIntWithDefault("DPM.StreamBatchSize", 0),
+    iceProps->getPropertyAsIntWithDefault("DPM.StreamIntervalMs", 0));
+
+  // let a stop request abort the detections mid-image rather than
+  // waiting for the pyramid, convolution and DP to run to completion
+  const PartsBasedDetector<T>* detector = _model.get();
+  StopToken token(mServiceMan);
+  DetectOptions options(minObjectSize, maxObjectSize);
+  options.cancel = &token;
+  boost::scoped_ptr<AsyncDetector<T> > pool;
+  if (detector != NULL)
+    pool.reset(new AsyncDetector<T>(*detector, nWorkers, nWorkers));
+
+  // iterate the RunSet on this thread before the pipeline starts. The
+  // iterator may grow its result set as it goes, so results are located by
+  // index until the iteration is complete. From then on the result set is
+  // never resized, so the Result pointers stay valid while the reporter
+  // thread writes the labels into them
+  std::vector<RunSetItem> items;
+  std::vector<size_t> resultIndex;
+  while (_it.hasNext())
+  {
+    RunSetItem runSetItem;
+    runSetItem.labelable = &*(_it.getNext());
+    runSetItem.result = NULL;
+    resultIndex.push_back(&_it.getCurrentResult() - &_it.getResultSet().results[0]);
+    items.push_back(runSetItem);
+  }
+  cvac::ResultSet& resultSet = _it.getResultSet();
+  for (size_t n = 0; n < items.size(); ++n)
+    items[n].result = &resultSet.results[resultIndex[n]];
+
+  ResultQueue decoded(nPrefetch);
+  ResultQueue detected(2*nWorkers);
+  StageCounter decodeCount, detectCount, reportCount;
+  double detectBusy = 0;
+  bool stopped = false;
   mServiceMan->setStoppable();
-  while(mRunsetIterator.hasNext())
+  boost::thread decoder(boost::bind(&DPMDetectionI::decodeStage<T>, this, detector,
+    &items, _callback, &options, &decoded, &decodeCount, &stopped));
+  boost::thread reporter(boost::bind(&DPMDetectionI::reportStage, this,
+    &detected, &reportCount, &detectBusy, &stream, slowImageMs));
+
+  // detection stage: submissions block while every worker is busy, which
+  // counts as stalled here. The detection time itself is measured by the
+  // reporter, from submission until the result is ready
+  PendingResult item;
+  while (decoded.pop(item))
   {
-    if((mServiceMan != NULL) && (mServiceMan->stopRequested()))
-    {        
-      mServiceMan->stopCompleted();
-      break;
+    int64 t0 = cv::getTickCount();
+    item.submitted = t0;
+    if (!item.image.empty())
+    {
+      DetectOptions imageOptions = options;
+      imageOptions.inputScale = item.inputScale;
+      imageOptions.stats = item.stats.get();
+      item.future = boost::shared_future<vectorCandidate>(pool->submit(item.image, imageOptions));
     }
+    item.image.release();
+    detected.push(item);
+    detectCount.add(t0, t0, cv::getTickCount());
+  }
+  detected.close();
+  decoder.join();
+  reporter.join();
+  pool.reset();
+  detectCount.busy = detectBusy;
+
+  double freq = cv::getTickFrequency();
+  localAndClientMsg(VLogger::INFO, NULL,
+    "Processed %d images: decode %.3fs (%.3fs stalled), detect %.3fs summed latency "
+    "(%.3fs stalled on workers), report %.3fs (%.3fs waiting for detections)\n",
+    (int)reportCount.items, decodeCount.busy/freq, decodeCount.stalled/freq,
+    detectCount.busy/freq, detectCount.stalled/freq,
+    reportCount.busy/freq, reportCount.stalled/freq);
+
+  if (stopped)
+    mServiceMan->stopCompleted();
+  if (stream.enabled())
+  {
+    stream.flush();
+    localAndClientMsg(VLogger::DEBUG, NULL, "Streamed results in %d batches\n",
+                      (int)stream.flushes());
+  }
+  else
+    _callback->foundNewResults(_it.getResultSet());
+  mServiceMan->clearStop();
+}
 
-    cvac::Labelable& labelable = *(mRunsetIterator.getNext());
+/** decoder stage: read the image of each RunSet item, queueing it for
+ *  detection. Stops early on a stop request. The items were collected from
+ *  the iterator by the calling thread, so the iterator and its result set
+ *  are not touched here
+ */
+template<typename T>
+void DPMDetectionI::decodeStage(const PartsBasedDetector<T>* _detector,
+                                const std::vector<RunSetItem>* _items,
+                                cvac::CallbackHandlerPrx _callback,
+                                const DetectOptions* _options,
+                                ResultQueue* _out,
+                                StageCounter* _count,
+                                bool* _stopped)
+{
+  try
+  {
+    // a context of our own to pick the reduction of each image with
+    boost::scoped_ptr<DetectionContext<T> > context;
+    if (_detector != NULL)
+      context.reset(_detector->createContext());
+    for (size_t n = 0; n < _items->size(); ++n)
     {
-      bool _resFlag(false);
-      std::string _resStr;
-      std::vector<Candidate> objects = detectObjects( callback, labelable, _resFlag,_resStr);
-      addResult(mRunsetIterator.getCurrentResult(),labelable,objects,_resFlag,_resStr);      
+      if((mServiceMan != NULL) && (mServiceMan->stopRequested()))
+      {
+        *_stopped = true;
+        break;
+      }
+      int64 t0 = cv::getTickCount();
+      PendingResult item;
+      item.labelable = (*_items)[n].labelable;
+      item.result = (*_items)[n].result;
+      int64 tRead = cv::getTickCount();
+      item.image = readImage(_callback, *item.labelable, *_options, context.get(),
+                             item.inputScale, item.resFlag, item.resStr);
+      int64 t1 = cv::getTickCount();
+      item.stats->decodeTime = (t1 - tRead) / cv::getTickFrequency();
+      bool queued = _out->push(item);
+      _count->add(t0, t1, cv::getTickCount());
+      if (!queued)
+        break;
     }
-  }  
-  callback->foundNewResults(mRunsetIterator.getResultSet());
-  mServiceMan->clearStop();
+  }
+  catch (const std::exception& e)
+  {
+    localAndClientMsg(VLogger::ERROR, NULL, "Reading images failed: %s\n", e.what());
+  }
+  _out->close();
+}
+
+/** reporter stage: wait for each detection in submission order and add
+ *  its result, accumulating the detection latencies in _detectBusy. When
+ *  streaming, partial batches that fall due while waiting, either for the
+ *  next image to reach this stage or for its detection, are flushed on time
+ */
+void DPMDetectionI::reportStage(ResultQueue* _in,
+                                StageCounter* _count,
+                                double* _detectBusy,
+                                ResultStream* _stream,
+                                int _slowImageMs)
+{
+  PendingResult item;
+  for (;;)
+  {
+    if (_stream->pending())
+    {
+      if (!_in->timedPop(item, _stream->timeLeft()))
+      {
+        if (_in->closed() && _in->size() == 0)
+          break;
+        _stream->flush();
+        continue;
+      }
+    }
+    else if (!_in->pop(item))
+      break;
+    int64 t0 = cv::getTickCount();
+    if (item.future.valid())
+    {
+      while (_stream->pending() && !item.future.timed_wait(_stream->timeLeft()))
+        _stream->flush();
+      item.future.wait();
+      // time from submission until the detection finished, or until it
+      // was reached here if it finished earlier
+      *_detectBusy += cv::getTickCount() - item.submitted;
+    }
+    int64 t1 = cv::getTickCount();
+    reportResult(item, _slowImageMs);
+    _stream->add(*item.result);
+    _count->add(t0, t1, cv::getTickCount());
+  }
+}
+
+DPMDetectionI::ResultStream::ResultStream(cvac::DetectorCallbackHandlerPrx callback,
+                                          int batchSize, int intervalMs)
+  :mCallback(callback), mBatchSize(std::max(batchSize, 0)),
+   mIntervalMs(std::max(intervalMs, 0)), mBatchStart(0), mFlushes(0)
+{
+}
+
+boost::posix_time::milliseconds DPMDetectionI::ResultStream::timeLeft() const
+{
+  double elapsed = (cv::getTickCount() - mBatchStart) * 1000.0 / cv::getTickFrequency();
+  return boost::posix_time::milliseconds(std::max(0, mIntervalMs - (int)elapsed));
+}
+
+/** queue a completed result for the client, flushing the batch if it is
+ *  full or due. The labels are moved into the batch, so they are only held
+ *  until the batch is sent
+ */
+void DPMDetectionI::ResultStream::add(cvac::Result& result)
+{
+  if (!enabled())
+    return;
+  if (mBatch.results.empty())
+    mBatchStart = cv::getTickCount();
+  mBatch.results.push_back(result);
+  result.foundLabels.clear();
+  if ((mBatchSize > 0 && mBatch.results.size() >= mBatchSize) ||
+      (mIntervalMs > 0 && timeLeft().total_milliseconds() == 0))
+    flush();
 }
 
-/** run the cascade on the image described in lbl,
- *  return the objects (rectangles) that were found
+/** send the queued results to the client
  */
-std::vector<Candidate> DPMDetectionI::detectObjects(const CallbackHandlerPrx& _callback,
-                                                    const cvac::Labelable& _lbl,
-                                                    bool& _resFlag,
-                                                    std::string& _resStr)
+void DPMDetectionI::ResultStream::flush()
+{
+  if (mBatch.results.empty())
+    return;
+  try
+  {
+    mCallback->foundNewResults(mBatch);
+  }
+  catch (const Ice::Exception& e)
+  {
+    localAndClientMsg(VLogger::WARN, NULL, "Sending results failed: %s\n", e.what());
+  }
+  mBatch.results.clear();
+  ++mFlushes;
+}
+
+/** read the image described in lbl, returning an empty image
+ *  (and the reason in _resStr) if it cannot be processed. If the minimum
+ *  object size rules out the finest octaves of the pyramid, JPEGs are
+ *  decoded at 1/2, 1/4 or 1/8 resolution, and _inputScale set to match
+ */
+template<typename T>
+cv::Mat DPMDetectionI::readImage(const CallbackHandlerPrx& _callback,
+                                 const cvac::Labelable& _lbl,
+                                 const DetectOptions& _options,
+                                 DetectionContext<T>* _context,
+                                 float& _inputScale,
+                                 bool& _resFlag,
+                                 std::string& _resStr)
 {
   FilePath fpath = RunSetWrapper::getFilePath(_lbl);
   string tfilepath = getFSPath( fpath, m_CVAC_DataDir );
@@ -293,9 +599,19 @@ std::vector<Candidate> DPMDetectionI::detectObjects(const CallbackHandlerPrx& _c
   _resStr = "";
   _resFlag = false;
 
-  std::vector<Candidate> _candidates;
-  cv::Mat _depth;
-  cv::Mat _img = cv::imread(tfilepath.c_str());
+  if (_context == NULL)
+  {
+    _resStr = "Error: no model loaded";
+    return cv::Mat();
+  }
+  int denom = 1;
+  cv::Size fullSize;
+  if (_options.minObjectSize > 0 &&
+      ReducedImageReader::size(tfilepath, fullSize))
+    denom = _context->inputReduction(fullSize, _options);
+  _inputScale = 1.0f / denom;
+  cv::Mat _img = (denom == 1) ? cv::imread(tfilepath.c_str())
+                              : ReducedImageReader::read(tfilepath, denom);
   if (_img.empty())//no file or not supported format
   {
     std::string msgout;
@@ -306,21 +622,84 @@ std::vector<Candidate> DPMDetectionI::detectObjects(const CallbackHandlerPrx& _c
     _resStr = "Error: no file or not supported format";
     _resFlag = false;
   }
-  else
-  { 
-    float confidence = 1.0f;
-    DPMDetectionI* _pDPM = static_cast<DPMDetectionI*>(this);
-    _pDPM->pbd.detect(_img, _depth, _candidates);
-    _resStr = "";
-    _resFlag = true;
+  return _img;
+}
+
+/** wait for the detection of a submitted image and add its result,
+ *  logging its stage costs at INFO if it took _slowImageMs or longer
+ */
+void DPMDetectionI::reportResult(PendingResult& _item, int _slowImageMs)
+{
+  std::vector<Candidate> objects;
+  const DetectStats* stats = NULL;
+  if (_item.future.valid())
+  {
+    try
+    {
+      objects = _item.future.get();
+      _item.resStr = "";
+      _item.resFlag = true;
+      stats = _item.stats.get();
+    }
+    catch (const DetectionCancelled&)
+    {
+      _item.resStr = "Cancelled";
+      _item.resFlag = false;
+    }
+    catch (const std::exception& e)
+    {
+      localAndClientMsg(VLogger::WARN, NULL, "Detection failed: %s\n", e.what());
+      _item.resStr = "Error: detection failed";
+      _item.resFlag = false;
+    }
+  }
+  if (stats != NULL)
+  {
+    // log the stage costs of the image, at INFO if it was slow
+    bool slow = (_slowImageMs > 0 && stats->totalTime()*1000 >= _slowImageMs);
+    string file = getFSPath(RunSetWrapper::getFilePath(*_item.labelable), m_CVAC_DataDir);
+    localAndClientMsg(slow ? VLogger::INFO : VLogger::DEBUG, NULL,
+      "%s%s: %.1f ms (decode %.1f, pyramid %.1f, convolution %.1f, dp %.1f, nms %.1f), "
+      "%d levels, %d/%d candidates after nms, %.1f MB scratch\n",
+      slow ? "Slow image " : "", file.c_str(), stats->totalTime()*1000,
+      stats->decodeTime*1000, stats->pyramidTime*1000, stats->convolutionTime*1000,
+      stats->dpTime*1000, stats->nmsTime*1000, (int)stats->levels,
+      (int)stats->candidates, (int)stats->rawCandidates, stats->scratchBytes/1048576.0);
   }
-  return _candidates; 
+  addResult(*_item.result, *_item.labelable, objects, _item.resFlag, _item.resStr, stats);
+}
+
+/** attach the stage costs of a detection to a result label as properties
+ *  (times in milliseconds)
+ */
+static void addStats(cvac::Label& _lab, const DetectStats& _stats)
+{
+  char buf[32];
+  sprintf(buf, "%.3f", _stats.decodeTime*1000);
+  _lab.properties["DPM.decodeMs"] = buf;
+  sprintf(buf, "%.3f", _stats.pyramidTime*1000);
+  _lab.properties["DPM.pyramidMs"] = buf;
+  sprintf(buf, "%.3f", _stats.convolutionTime*1000);
+  _lab.properties["DPM.convolutionMs"] = buf;
+  sprintf(buf, "%.3f", _stats.dpTime*1000);
+  _lab.properties["DPM.dpMs"] = buf;
+  sprintf(buf, "%.3f", _stats.nmsTime*1000);
+  _lab.properties["DPM.nmsMs"] = buf;
+  sprintf(buf, "%u", _stats.levels);
+  _lab.properties["DPM.levels"] = buf;
+  sprintf(buf, "%lu", (unsigned long)_stats.rawCandidates);
+  _lab.properties["DPM.rawCandidates"] = buf;
+  sprintf(buf, "%lu", (unsigned long)_stats.candidates);
+  _lab.properties["DPM.candidates"] = buf;
+  sprintf(buf, "%lu", (unsigned long)_stats.scratchBytes);
+  _lab.properties["DPM.scratchBytes"] = buf;
 }
 
 void DPMDetectionI::addResult(cvac::Result& _res,
                               cvac::Labelable& _converted,
                               std::vector<Candidate> _candidates,
-                              bool _resFlag,std::string _resStr)
+                              bool _resFlag,std::string _resStr,
+                              const DetectStats* _stats)
 {
   LabelablePtr labelable = new Labelable();
   
@@ -345,6 +724,8 @@ void DPMDetectionI::addResult(cvac::Result& _res,
       labelable->lab.hasLabel = true;
     }
   }
+  if (_stats != NULL)
+    addStats(labelable->lab, *_stats);
   _res.foundLabels.push_back(labelable);
 }
 
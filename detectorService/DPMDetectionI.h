@@ -50,12 +50,20 @@
 #include <util/RunSetIterator.h>
 #include <util/DetectorDataArchive.h>
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 //#include <opencv2/opencv.hpp>
 
+#include <AsyncDetector.hpp>
+#include <BoundedQueue.hpp>
 #include <PartsBasedDetector.hpp>
+#include <ReducedImageReader.hpp>
 #include <Candidate.hpp>
+#include <CancellationToken.hpp>
 #include <FileStorageModel.hpp>
+#include <BinaryModel.hpp>
 #include <Visualize.hpp> //only for visualization of results
+#include "ModelRegistry.h"
 
 class DPMDetectionI : public cvac::Detector, public cvac::StartStop
 {
@@ -81,21 +89,122 @@ public:
 protected:
   bool initialize(cvac::DetectorDataArchive* _dda,
                   const ::cvac::FilePath &file,
-                  const::Ice::Current &current);
-  bool isInitialized();
+                  const::Ice::Current &current,
+                  ModelRegistry<float>::Lease& _modelFloat,
+                  ModelRegistry<double>::Lease& _modelDouble);
+  template<typename T>
+  typename ModelRegistry<T>::DetectorPtr loadDetector(cvac::DetectorDataArchive* _dda,
+                                                      const std::string& clientDir,
+                                                      const std::string& zipfilepath);
   virtual void destroy(const ::Ice::Current& current);
 
 private:
+  // cancellation token that reports a pending stop request of the service
+  class StopToken : public CancellationToken
+  {
+  public:
+    StopToken(cvac::ServiceManager *sman) : mSMan(sman) {}
+    virtual bool cancelled() const
+    {
+      return CancellationToken::cancelled() ||
+        ((mSMan != NULL) && mSMan->stopRequested());
+    }
+  private:
+    cvac::ServiceManager *mSMan;
+  };
+
+  // sends results to the client in batches as images complete, rather than
+  // all at once after the RunSet. A batch is flushed once it holds
+  // batchSize results or its first result is intervalMs old (0 for no limit)
+  class ResultStream
+  {
+  public:
+    ResultStream(cvac::DetectorCallbackHandlerPrx callback, int batchSize, int intervalMs);
+    bool enabled() const { return mBatchSize > 0 || mIntervalMs > 0; }
+    // whether a partial batch is waiting on its time limit
+    bool pending() const { return mIntervalMs > 0 && !mBatch.results.empty(); }
+    // the time until the partial batch is due
+    boost::posix_time::milliseconds timeLeft() const;
+    void add(cvac::Result& result);
+    void flush();
+    size_t flushes() const { return mFlushes; }
+  private:
+    cvac::DetectorCallbackHandlerPrx mCallback;
+    size_t mBatchSize;
+    int mIntervalMs;
+    cvac::ResultSet mBatch;
+    int64 mBatchStart;  // tick count of the first result in the batch
+    size_t mFlushes;
+  };
+
+  // requests may overlap, so the model lease and the per-request settings
+  // are held by process() rather than here
   cvac::ServiceManager *mServiceMan;
-  PartsBasedDetector<double> pbd;  
-  bool  fInitialized;
   std::string filepathDefaultModel;
 
-  std::vector<Candidate> detectObjects(const cvac::CallbackHandlerPrx& _callback,
-                                      const cvac::Labelable& _lbl,
-                                      bool& _resFlag,std::string& _resStr);
+  // an image of the RunSet and the result it is reported in
+  struct RunSetItem
+  {
+    cvac::Labelable* labelable;
+    cvac::Result* result;
+  };
+
+  // an image on its way through the decode, detect and report stages
+  struct PendingResult
+  {
+    PendingResult() : labelable(NULL), result(NULL), inputScale(1),
+                      stats(new DetectStats), submitted(0), resFlag(false) {}
+    cvac::Labelable* labelable;
+    cvac::Result* result;
+    cv::Mat image;                                 // released once submitted
+    float inputScale;                              // resolution image was read at
+    boost::shared_ptr<DetectStats> stats;          // filled by the worker
+    boost::shared_future<vectorCandidate> future;  // invalid if not submitted
+    int64 submitted;                               // tick count at submission
+    bool resFlag;
+    std::string resStr;
+  };
+  typedef BoundedQueue<PendingResult> ResultQueue;
+
+  // per-stage timing, in cv::getTickCount() ticks: busy doing the stage's
+  // work, and stalled waiting on the neighbouring stages
+  struct StageCounter
+  {
+    StageCounter() : items(0), busy(0), stalled(0) {}
+    void add(int64 start, int64 worked, int64 end)
+    {
+      ++items;
+      busy += worked - start;
+      stalled += end - worked;
+    }
+    size_t items;
+    double busy;
+    double stalled;
+  };
+
+  template<typename T>
+  void detectRunSet(const typename ModelRegistry<T>::Lease& _model, cvac::RunSetIterator& _it,
+                    cvac::DetectorCallbackHandlerPrx _callback,
+                    const ::Ice::Current& current);
+  template<typename T>
+  void decodeStage(const PartsBasedDetector<T>* _detector,
+                   const std::vector<RunSetItem>* _items, cvac::CallbackHandlerPrx _callback,
+                   const DetectOptions* _options, ResultQueue* _out,
+                   StageCounter* _count, bool* _stopped);
+  void reportStage(ResultQueue* _in, StageCounter* _count, double* _detectBusy,
+                   ResultStream* _stream, int _slowImageMs);
+
+  template<typename T>
+  cv::Mat readImage(const cvac::CallbackHandlerPrx& _callback,
+                    const cvac::Labelable& _lbl,
+                    const DetectOptions& _options,
+                    DetectionContext<T>* _context,
+                    float& _inputScale,
+                    bool& _resFlag,std::string& _resStr);
+  void reportResult(PendingResult& _item, int _slowImageMs);
   void addResult(cvac::Result& _res,cvac::Labelable& _converted,
-                 std::vector<Candidate> _candidates,bool _resFlag,std::string _resStr);
+                 std::vector<Candidate> _candidates,bool _resFlag,std::string _resStr,
+                 const DetectStats* _stats = NULL);
 
 //     static cvac::ResultSet processSingleImg(cvac::DetectorPtr detector,const char* fullfilename);    
 //     std::string getPathDetectorData();
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * CVAC Software Disclaimer
+ * 
+ * This software was developed at the Naval Postgraduate School, Monterey, CA,
+ * by employees of the Federal Government in the course of their official duties.
+ * Pursuant to title 17 Section 105 of the United States Code this software
+ * is not subject to copyright protection and is in the public domain. It is 
+ * an experimental system.  The Naval Postgraduate School assumes no
+ * responsibility whatsoever for its use by other parties, and makes
+ * no guarantees, expressed or implied, about its quality, reliability, 
+ * or any other characteristic.
+ * We would appreciate acknowledgement and a brief notification if the software
+ * is used.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above notice,
+ *       this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Naval Postgraduate School, nor the name of
+ *       the U.S. Government, nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without
+ *       specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE NAVAL POSTGRADUATE SCHOOL (NPS) AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL NPS OR THE U.S. BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#include "ModelRegistry.h"
+#include <sstream>
+#include <boost/filesystem.hpp>
+
+template<typename T>
+ModelRegistry<T> ModelRegistry<T>::sInstance;
+
+template<typename T>
+ModelRegistry<T>::ModelRegistry(size_t maxBytes, size_t maxEntries)
+  :mBytes(0), mMaxBytes(maxBytes), mMaxEntries(maxEntries)
+{
+}
+
+template<typename T>
+typename ModelRegistry<T>::Lease ModelRegistry<T>::acquire(const std::string& archive, const Loader& load)
+{
+  // key on the archive's identity on disk, so a replaced archive is reloaded
+  boost::system::error_code ec;
+  const std::time_t mtime = boost::filesystem::last_write_time(archive, ec);
+  if (ec)
+    return Lease();
+  const boost::uintmax_t fsize = boost::filesystem::file_size(archive, ec);
+  if (ec)
+    return Lease();
+  std::ostringstream kstr;
+  kstr << archive << '|' << mtime << '|' << fsize;
+  const std::string key = kstr.str();
+
+  // find or create the entry, most recently used first
+  SlotPtr slot;
+  {
+    boost::mutex::scoped_lock lock(mMutex);
+    typename Index::iterator it = mIndex.find(key);
+    if (it != mIndex.end())
+    {
+      mEntries.splice(mEntries.begin(), mEntries, it->second);
+      slot = it->second->slot;
+    }
+    else
+    {
+      // drop stale versions of the same archive
+      for (typename EntryList::iterator e = mEntries.begin(); e != mEntries.end(); )
+      {
+        if (e->path == archive)
+        {
+          mBytes -= e->slot->bytes;
+          mIndex.erase(e->key);
+          e = mEntries.erase(e);
+        }
+        else
+          ++e;
+      }
+      Entry entry;
+      entry.key = key;
+      entry.path = archive;
+      entry.slot.reset(new Slot);
+      mEntries.push_front(entry);
+      mIndex[key] = mEntries.begin();
+      slot = entry.slot;
+    }
+  }
+
+  // load outside the registry lock, so only requests for this archive wait
+  DetectorPtr loaded;
+  {
+    boost::mutex::scoped_lock lock(slot->mutex);
+    if (slot->detector)
+      return Lease(slot);
+    loaded = load(archive);
+    slot->detector = loaded;
+  }
+
+  // account for the new detector, unless it was evicted while loading
+  boost::mutex::scoped_lock lock(mMutex);
+  typename Index::iterator it = mIndex.find(key);
+  const bool registered = (it != mIndex.end() && it->second->slot == slot);
+  if (!loaded)
+  {
+    if (registered)
+    {
+      mEntries.erase(it->second);
+      mIndex.erase(it);
+    }
+    return Lease();
+  }
+  if (registered)
+  {
+    slot->bytes = loaded->footprint();
+    mBytes += slot->bytes;
+    evict();
+  }
+  return Lease(slot);
+}
+
+template<typename T>
+void ModelRegistry<T>::setCapacity(size_t maxBytes, size_t maxEntries)
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  mMaxBytes = maxBytes;
+  mMaxEntries = maxEntries;
+  evict();
+}
+
+template<typename T>
+void ModelRegistry<T>::clear()
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  mEntries.clear();
+  mIndex.clear();
+  mBytes = 0;
+}
+
+template<typename T>
+size_t ModelRegistry<T>::bytes() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mBytes;
+}
+
+template<typename T>
+size_t ModelRegistry<T>::size() const
+{
+  boost::mutex::scoped_lock lock(mMutex);
+  return mEntries.size();
+}
+
+// evict least recently used entries until within capacity, always keeping
+// the most recently used one. Called with mMutex held
+template<typename T>
+void ModelRegistry<T>::evict()
+{
+  while (mEntries.size() > 1 && (mEntries.size() > mMaxEntries || mBytes > mMaxBytes))
+  {
+    Entry& lru = mEntries.back();
+    mBytes -= lru.slot->bytes;
+    mIndex.erase(lru.key);
+    mEntries.pop_back();
+  }
+}
+
+// declare all specializations of the template
+template class ModelRegistry<float>;
+template class ModelRegistry<double>;
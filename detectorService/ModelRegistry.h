@@ -0,0 +1,144 @@
+#ifndef _ModelRegistry_H__
+/*****************************************************************************
+ * CVAC Software Disclaimer
+ * 
+ * This software was developed at the Naval Postgraduate School, Monterey, CA,
+ * by employees of the Federal Government in the course of their official duties.
+ * Pursuant to title 17 Section 105 of the United States Code this software
+ * is not subject to copyright protection and is in the public domain. It is 
+ * an experimental system.  The Naval Postgraduate School assumes no
+ * responsibility whatsoever for its use by other parties, and makes
+ * no guarantees, expressed or implied, about its quality, reliability, 
+ * or any other characteristic.
+ * We would appreciate acknowledgement and a brief notification if the software
+ * is used.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above notice,
+ *       this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above notice,
+ *       this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Naval Postgraduate School, nor the name of
+ *       the U.S. Government, nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without
+ *       specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE NAVAL POSTGRADUATE SCHOOL (NPS) AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL NPS OR THE U.S. BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************/
+#define _ModelRegistry_H__
+
+#include <list>
+#include <map>
+#include <string>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <PartsBasedDetector.hpp>
+
+/**
+ * Process-wide cache of ready-to-use detectors, keyed by the trained model
+ * archive they were loaded from. Repeated requests for the same archive
+ * skip unzipping, deserializing and distributing the model.
+ *
+ * Entries are keyed by the archive path, modification time and size, so a
+ * replaced archive is loaded afresh. The least recently used entries are
+ * evicted once the registry holds more than maxEntries detectors or more
+ * than maxBytes of model state (as estimated by footprint()). Evicted
+ * detectors stay alive until the last request using them releases its Lease.
+ *
+ * Each entry has its own mutex: concurrent requests for an archive that is
+ * not loaded yet wait for a single load, without blocking requests for other
+ * archives. The detectors are shared, so detect on them through contexts
+ * from createContext() rather than directly.
+ *
+ * There is one registry per detector precision T.
+ */
+template<typename T>
+class ModelRegistry : private boost::noncopyable
+{
+public:
+  typedef PartsBasedDetector<T> Detector;
+  typedef boost::shared_ptr<Detector> DetectorPtr;
+  // loads a detector from an archive, returning an empty pointer on failure
+  typedef boost::function<DetectorPtr (const std::string&)> Loader;
+
+private:
+  struct Slot
+  {
+    Slot() : bytes(0) {}
+    boost::mutex mutex;
+    DetectorPtr detector;
+    size_t bytes;
+  };
+  typedef boost::shared_ptr<Slot> SlotPtr;
+  struct Entry
+  {
+    std::string key;
+    std::string path;
+    SlotPtr slot;
+  };
+  typedef std::list<Entry> EntryList;
+  typedef std::map<std::string, typename EntryList::iterator> Index;
+
+public:
+  /**
+   * A shared reference to a registered detector.
+   */
+  class Lease
+  {
+  public:
+    Lease() {}
+    Detector* operator->() const { return mSlot->detector.get(); }
+    Detector& operator*() const { return *mSlot->detector; }
+    Detector* get() const { return empty() ? NULL : mSlot->detector.get(); }
+    bool empty() const { return !mSlot || !mSlot->detector; }
+  private:
+    friend class ModelRegistry;
+    explicit Lease(const SlotPtr& slot) : mSlot(slot) {}
+    SlotPtr mSlot;
+  };
+
+  ModelRegistry(size_t maxBytes = 512*1024*1024, size_t maxEntries = 8);
+
+  // the registry of precision T shared by all services in the process
+  static ModelRegistry& instance() { return sInstance; }
+
+  /**
+   * Get the detector for an archive, loading it with load() if it is not
+   * registered yet. Returns an empty Lease if the archive does not exist or
+   * fails to load.
+   */
+  Lease acquire(const std::string& archive, const Loader& load);
+
+  void setCapacity(size_t maxBytes, size_t maxEntries);
+  void clear();
+  size_t bytes() const;
+  size_t size() const;
+
+private:
+  void evict();
+
+  // constructed during static initialization, before any service starts
+  static ModelRegistry sInstance;
+  mutable boost::mutex mMutex;
+  EntryList mEntries;                 // most recently used first
+  Index mIndex;
+  size_t mBytes;
+  size_t mMaxBytes;
+  size_t mMaxEntries;
+};
+
+#endif //_ModelRegistry_H__
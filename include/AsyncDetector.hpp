@@ -0,0 +1,95 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    AsyncDetector.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef ASYNCDETECTOR_HPP_
+#define ASYNCDETECTOR_HPP_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/future.hpp>
+#include "BoundedQueue.hpp"
+#include "Candidate.hpp"
+#include "DetectOptions.hpp"
+#include "DetectionContext.hpp"
+#include "PartsBasedDetector.hpp"
+#include "types.hpp"
+
+/*! @class AsyncDetector
+ *  @brief asynchronous front-end to a PartsBasedDetector
+ *
+ * Images submitted to the AsyncDetector are queued and detected by a pool of
+ * worker threads, each with its own DetectionContext over the detector's
+ * shared model. submit() returns a future for the candidates
+ * immediately, so a producer can keep decoding frames while earlier frames
+ * are still being detected. The submission queue is bounded: when it is full,
+ * submit() blocks until a worker takes the next image (backpressure)
+ *
+ * The wrapped detector must have its model distributed before the
+ * AsyncDetector is constructed. The workers take the detector's settings at
+ * construction, and share its model rather than the detector itself. Submitted images are
+ * shared rather than copied, so they must not be modified until their
+ * future is ready
+ *
+ * @tparam T the detector precision
+ */
+template<typename T>
+class AsyncDetector {
+private:
+	//! a queued detection
+	struct Job {
+		cv::Mat image;
+		DetectOptions options;
+		boost::shared_ptr<boost::promise<vectorCandidate> > promise;
+	};
+	//! the submission queue
+	BoundedQueue<Job> queue_;
+	//! the worker threads
+	boost::thread_group workers_;
+	// private methods
+	void work(boost::shared_ptr<DetectionContext<T> > context);
+public:
+	AsyncDetector(const PartsBasedDetector<T>& detector, unsigned int nworkers = 0, size_t capacity = 8);
+	virtual ~AsyncDetector();
+	boost::unique_future<vectorCandidate> submit(const cv::Mat& im, const DetectOptions& options = DetectOptions());
+	void shutdown(void);
+	//! the number of images waiting for a worker
+	size_t pending(void) const { return queue_.size(); }
+};
+
+#endif /* ASYNCDETECTOR_HPP_ */
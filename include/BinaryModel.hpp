@@ -0,0 +1,88 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BinaryModel.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef BINARYMODEL_HPP_
+#define BINARYMODEL_HPP_
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include "Model.hpp"
+
+class MappedFile;
+
+/*! @class BinaryModel
+ *  @brief Model with a flat, memory-mappable binary (de-)serialization
+ *
+ * Parsing a large mixture model through cv::FileStorage is slow enough to
+ * dominate startup. The binary format instead lays every model parameter out
+ * as a flat, aligned section so that deserialization amounts to mapping the
+ * file into memory and pointing at it:
+ *
+ *  - a fixed size header (magic, byte order marker, version, primitives)
+ *    followed by a table of (offset, count) section descriptors
+ *  - a filter table of (rows, cols, type, offset) entries and a single blob
+ *    holding all the filter weights. The filters are cv::Mat headers onto
+ *    the mapped blob and are not copied on load
+ *  - the bias and deformation weights and the anchors
+ *  - compressed row (CSR) index tables for filterid_, biasid_, defid_ and
+ *    parentid_, indexed by component and part
+ *
+ * Every section is aligned to a cache line. The file is written in host byte
+ * order; a model written on a machine of different endianness is rejected.
+ * Files conventionally carry the ".dpm" extension
+ *
+ * The mapping is shared between copies of the model and released when the
+ * last one is destroyed. PartsBasedDetector::distributeModel() takes its own
+ * copy of the filters, so a model may be destroyed once distributed
+ */
+class BinaryModel: public Model {
+private:
+	//! the mapping backing the filter weights, if deserialized
+	boost::shared_ptr<MappedFile> map_;
+public:
+	//! the current version of the binary format
+	static const unsigned int VERSION = 1;
+	BinaryModel() {}
+	//! convert from any other model (eg. after deserializing from XML)
+	explicit BinaryModel(const Model& other) : Model(other) {}
+	virtual ~BinaryModel() {}
+	// persistence methods
+	bool deserialize(const std::string& filename);
+	bool serialize(const std::string& filename) const;
+};
+
+#endif /* BINARYMODEL_HPP_ */
@@ -0,0 +1,149 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BoundedQueue.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef BOUNDEDQUEUE_HPP_
+#define BOUNDEDQUEUE_HPP_
+
+#include <deque>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+
+/*! @class BoundedQueue
+ *  @brief thread-safe first-in first-out queue with a fixed capacity
+ *
+ * push() blocks while the queue is full, which applies backpressure to
+ * producers that outpace the consumers, and pop() blocks while the queue is
+ * empty. Once close() is called, pushes fail immediately and pops drain the
+ * remaining items before failing, so consumers can shut down cleanly
+ *
+ * @tparam T the item type (must be copyable)
+ */
+template<typename T>
+class BoundedQueue {
+private:
+	//! the queued items
+	std::deque<T> items_;
+	//! the maximum number of queued items
+	size_t capacity_;
+	//! whether the queue has been closed
+	bool closed_;
+	mutable boost::mutex mutex_;
+	boost::condition_variable not_full_;
+	boost::condition_variable not_empty_;
+public:
+	explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+	virtual ~BoundedQueue() {}
+
+	/*! @brief add an item to the back of the queue, waiting for space if necessary
+	 *
+	 * @param item the item to add
+	 * @return false if the queue was closed (the item is not added)
+	 */
+	bool push(const T& item) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		while (items_.size() >= capacity_ && !closed_) not_full_.wait(lock);
+		if (closed_) return false;
+		items_.push_back(item);
+		not_empty_.notify_one();
+		return true;
+	}
+
+	/*! @brief add an item to the back of the queue if there is space
+	 *
+	 * @param item the item to add
+	 * @return false if the queue was full or closed (the item is not added)
+	 */
+	bool tryPush(const T& item) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		if (items_.size() >= capacity_ || closed_) return false;
+		items_.push_back(item);
+		not_empty_.notify_one();
+		return true;
+	}
+
+	/*! @brief remove an item from the front of the queue, waiting for one if necessary
+	 *
+	 * @param item the removed item
+	 * @return false if the queue is closed and empty (item is untouched)
+	 */
+	bool pop(T& item) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		while (items_.empty() && !closed_) not_empty_.wait(lock);
+		if (items_.empty()) return false;
+		item = items_.front();
+		items_.pop_front();
+		not_full_.notify_one();
+		return true;
+	}
+
+	/*! @brief remove an item from the front of the queue, waiting at most timeout for one
+	 *
+	 * @param item the removed item
+	 * @param timeout the longest time to wait
+	 * @return false if no item arrived within the timeout, or the queue is
+	 * closed and empty (item is untouched). Check closed() to tell them apart
+	 */
+	bool timedPop(T& item, const boost::posix_time::time_duration& timeout) {
+		const boost::system_time deadline = boost::get_system_time() + timeout;
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		while (items_.empty() && !closed_) {
+			if (!not_empty_.timed_wait(lock, deadline)) break;
+		}
+		if (items_.empty()) return false;
+		item = items_.front();
+		items_.pop_front();
+		not_full_.notify_one();
+		return true;
+	}
+
+	//! close the queue, waking all waiting producers and consumers
+	void close(void) {
+		boost::unique_lock<boost::mutex> lock(mutex_);
+		closed_ = true;
+		not_full_.notify_all();
+		not_empty_.notify_all();
+	}
+	//! the number of queued items
+	size_t size(void) const { boost::unique_lock<boost::mutex> lock(mutex_); return items_.size(); }
+	//! the maximum number of queued items
+	size_t capacity(void) const { return capacity_; }
+	//! whether the queue has been closed
+	bool closed(void) const { boost::unique_lock<boost::mutex> lock(mutex_); return closed_; }
+};
+
+#endif /* BOUNDEDQUEUE_HPP_ */
@@ -0,0 +1,102 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CancellationToken.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef CANCELLATIONTOKEN_HPP_
+#define CANCELLATIONTOKEN_HPP_
+
+#include <stdexcept>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <opencv2/core/core.hpp>
+
+/*! @class DetectionCancelled
+ *  @brief thrown by the detection pipeline when its CancellationToken is cancelled
+ */
+class DetectionCancelled : public std::runtime_error {
+public:
+	DetectionCancelled() : std::runtime_error("detection cancelled") {}
+};
+
+/*! @class CancellationToken
+ *  @brief cooperative cancellation of a detection in progress
+ *
+ * The detection pipeline polls the token between pyramid levels, convolution
+ * tasks and dynamic program tasks. Once the token is cancelled, the remaining
+ * tasks are skipped and DetectionCancelled is thrown from the calling thread.
+ * Buffers local to the call are released as the stack unwinds, but the
+ * DetectionContext keeps its scratch buffers (pyramid, part responses and
+ * masks) at their current size for reuse by the next detection
+ *
+ * cancel() may be called from any thread. Subclasses may override cancelled()
+ * to poll an external stop condition instead
+ */
+class CancellationToken : private boost::noncopyable {
+private:
+	//! whether cancel() has been called
+	boost::atomic<bool> cancelled_;
+public:
+	CancellationToken() : cancelled_(false) {}
+	virtual ~CancellationToken() {}
+	//! request cancellation
+	void cancel(void) { cancelled_.store(true); }
+	//! whether cancellation has been requested
+	virtual bool cancelled(void) const { return cancelled_.load(); }
+	//! whether a (possibly null) token has been cancelled
+	static bool isCancelled(const CancellationToken* token) { return token && token->cancelled(); }
+	//! throw DetectionCancelled if a (possibly null) token has been cancelled
+	static void check(const CancellationToken* token) { if (isCancelled(token)) throw DetectionCancelled(); }
+};
+
+/*! @class DeadlineToken
+ *  @brief a CancellationToken which is also cancelled once a deadline has passed
+ *
+ * Since the pipeline polls between tasks, a detection overruns the deadline
+ * by at most the duration of one pyramid level, convolution task or dynamic
+ * program task
+ */
+class DeadlineToken : public CancellationToken {
+private:
+	//! the deadline, in cv::getTickCount() ticks
+	int64 deadline_;
+public:
+	explicit DeadlineToken(int64 deadline) : deadline_(deadline) {}
+	virtual ~DeadlineToken() {}
+	//! whether cancellation has been requested or the deadline has passed
+	virtual bool cancelled(void) const { return CancellationToken::cancelled() || cv::getTickCount() >= deadline_; }
+};
+
+#endif /* CANCELLATIONTOKEN_HPP_ */
@@ -0,0 +1,185 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CandidateSet.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef CANDIDATESET_HPP_
+#define CANDIDATESET_HPP_
+#include <algorithm>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "Candidate.hpp"
+#include "types.hpp"
+
+/*! @class CandidateSet
+ *  @brief flat storage for a large number of detection candidates
+ *
+ * CandidateSet stores the same information as a vector of Candidate, but as a
+ * structure of arrays: the root scores, components and part offsets of each
+ * candidate are held in contiguous vectors, and the part bounding boxes of all
+ * candidates are packed end to end in a single vector. Appending a candidate
+ * therefore never allocates per candidate, which matters when backtracking
+ * produces thousands of raw candidates per frame.
+ *
+ * Use toCandidates() to convert to the vectorCandidate representation
+ * expected by the rest of the API
+ */
+class CandidateSet {
+private:
+	//! the root score of each candidate
+	vectorf scores_;
+	//! the model component of each candidate
+	vectori components_;
+	//! the offset of each candidate's first part into rects_ (size()+1 entries)
+	vectori offsets_;
+	//! the part bounding boxes of all candidates, packed end to end
+	std::vector<cv::Rect> rects_;
+
+	//! reserve at least n elements, at least doubling the capacity when growing
+	template<typename V> static void growTo(V& v, size_t n) {
+		if (n > v.capacity()) v.reserve(std::max(n, 2*v.capacity()));
+	}
+
+	//! descending order of candidate indices by root score
+	struct Descending {
+		const vectorf& scores;
+		Descending(const vectorf& s) : scores(s) {}
+		bool operator()(int a, int b) const { return scores[a] > scores[b]; }
+	};
+public:
+	CandidateSet() : offsets_(1, 0) {}
+	virtual ~CandidateSet() {}
+	//! the number of candidates in the set
+	unsigned int size(void) const { return scores_.size(); }
+	//! true if the set holds no candidates
+	bool empty(void) const { return scores_.empty(); }
+	//! remove all candidates, retaining the allocated storage
+	void clear(void) { scores_.clear(); components_.clear(); offsets_.resize(1); rects_.clear(); }
+	//! preallocate storage for N candidates of nparts parts each
+	void reserve(unsigned int N, unsigned int nparts) {
+		scores_.reserve(N); components_.reserve(N); offsets_.reserve(N+1); rects_.reserve(N*nparts);
+	}
+	/*! @brief make room for N more candidates of nparts parts each
+	 *
+	 * the storage grows geometrically, so building a set up from many small
+	 * batches (eg. one per component and scale) copies each candidate a
+	 * constant number of times on average rather than once per batch
+	 */
+	void grow(unsigned int N, unsigned int nparts) {
+		growTo(scores_, scores_.size() + N); growTo(components_, components_.size() + N);
+		growTo(offsets_, offsets_.size() + N); growTo(rects_, rects_.size() + (size_t)N*nparts);
+	}
+	//! the root score of candidate n
+	float score(unsigned int n) const { return scores_[n]; }
+	//! the model component of candidate n
+	int component(unsigned int n) const { return components_[n]; }
+	//! the number of parts of candidate n
+	unsigned int nparts(unsigned int n) const { return offsets_[n+1] - offsets_[n]; }
+	//! the part bounding boxes of candidate n (nparts(n) contiguous elements)
+	const cv::Rect* parts(unsigned int n) const { return &rects_[offsets_[n]]; }
+
+	/*! @brief add a candidate to the end of the set
+	 *
+	 * @param score the root score of the candidate
+	 * @param component the model component the candidate belongs to
+	 * @param parts pointer to the part bounding boxes, root first
+	 * @param nparts the number of parts
+	 */
+	void append(float score, int component, const cv::Rect* parts, unsigned int nparts) {
+		scores_.push_back(score);
+		components_.push_back(component);
+		rects_.insert(rects_.end(), parts, parts+nparts);
+		offsets_.push_back(rects_.size());
+	}
+
+	/*! @brief add all candidates of another set to the end of this set
+	 *
+	 * @param other the set to append
+	 */
+	void append(const CandidateSet& other) {
+		const int base = rects_.size();
+		scores_.insert(scores_.end(), other.scores_.begin(), other.scores_.end());
+		components_.insert(components_.end(), other.components_.begin(), other.components_.end());
+		rects_.insert(rects_.end(), other.rects_.begin(), other.rects_.end());
+		for (unsigned int n = 1; n < other.offsets_.size(); ++n) offsets_.push_back(base + other.offsets_[n]);
+	}
+
+	/*! @brief concatenate a number of sets (eg. per-thread buffers) into one
+	 *
+	 * @param sets the sets to merge, appended in order
+	 * @param merged the output set
+	 */
+	static void merge(const std::vector<CandidateSet>& sets, CandidateSet& merged) {
+		unsigned int N = merged.size(), R = merged.rects_.size();
+		for (unsigned int s = 0; s < sets.size(); ++s) { N += sets[s].size(); R += sets[s].rects_.size(); }
+		merged.scores_.reserve(N); merged.components_.reserve(N); merged.offsets_.reserve(N+1); merged.rects_.reserve(R);
+		for (unsigned int s = 0; s < sets.size(); ++s) merged.append(sets[s]);
+	}
+
+	/*! @brief the order of the candidates from best to worst
+	 *
+	 * @param order the output vector of candidate indices, sorted by descending root score
+	 */
+	void sortedIndices(vectori& order) const {
+		order.resize(size());
+		for (unsigned int n = 0; n < order.size(); ++n) order[n] = n;
+		std::stable_sort(order.begin(), order.end(), Descending(scores_));
+	}
+
+	/*! @brief materialize a single candidate
+	 *
+	 * @param n the index of the candidate
+	 * @return the Candidate, with the root score attached to the root part
+	 */
+	Candidate candidate(unsigned int n) const {
+		Candidate c;
+		c.setComponent(components_[n]);
+		for (int p = offsets_[n]; p < offsets_[n+1]; ++p) {
+			c.addPart(rects_[p], (p == offsets_[n]) ? scores_[n] : 0.0f);
+		}
+		return c;
+	}
+
+	/*! @brief adapter to the vectorCandidate representation
+	 *
+	 * @param candidates the vector to append the candidates to, in set order
+	 */
+	void toCandidates(vectorCandidate& candidates) const {
+		candidates.reserve(candidates.size() + size());
+		for (unsigned int n = 0; n < size(); ++n) candidates.push_back(candidate(n));
+	}
+};
+
+#endif /* CANDIDATESET_HPP_ */
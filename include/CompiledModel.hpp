@@ -0,0 +1,95 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CompiledModel.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef COMPILEDMODEL_HPP_
+#define COMPILEDMODEL_HPP_
+
+#include <string>
+#include <boost/noncopyable.hpp>
+#include "Model.hpp"
+#include "Parts.hpp"
+#include "types.hpp"
+
+/*! @class CompiledModel
+ *  @brief the immutable, detection-ready state of a model
+ *
+ * A CompiledModel holds everything about a model that does not change from
+ * one detection to the next: the tree of Parts with its filters converted to
+ * the detector precision, the filters split into planes for convolution, the
+ * feature parameters and the detection threshold. It is never modified after
+ * construction, so a single instance (and a single copy of the filters) can
+ * be shared by any number of DetectionContexts on any number of threads
+ *
+ * @tparam T the detector precision
+ */
+template<typename T>
+class CompiledModel : private boost::noncopyable {
+private:
+	//! the name of the model
+	std::string name_;
+	//! the tree of Parts, holding the filters in the detector precision
+	Parts parts_;
+	//! the filters split into planes, indexed by filter then plane
+	vector2DMat planes_;
+	//! the spatial pooling size when computing features
+	unsigned int binsize_;
+	//! the number of scales per octave at which to compute features
+	unsigned int nscales_;
+	//! the length of the feature vector in each bin
+	unsigned int flen_;
+	//! the number of orientations per HOG feature bin
+	unsigned int norient_;
+	//! the threshold for a positive detection
+	double thresh_;
+	//! whether the filter planes were read from the filter bank cache
+	bool cached_;
+public:
+	CompiledModel(Model& model, float threshold = 1.0f, const std::string& cache = std::string());
+	virtual ~CompiledModel() {}
+	const std::string& name(void) const { return name_; }
+	const Parts& parts(void) const { return parts_; }
+	const vector2DMat& planes(void) const { return planes_; }
+	unsigned int binsize(void) const { return binsize_; }
+	unsigned int nscales(void) const { return nscales_; }
+	unsigned int flen(void) const { return flen_; }
+	unsigned int norient(void) const { return norient_; }
+	double thresh(void) const { return thresh_; }
+	bool cached(void) const { return cached_; }
+	size_t footprint(void) const;
+};
+
+#endif /* COMPILEDMODEL_HPP_ */
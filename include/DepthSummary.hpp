@@ -0,0 +1,108 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DepthSummary.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef DEPTHSUMMARY_HPP_
+#define DEPTHSUMMARY_HPP_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+/*! @class DepthSummary
+ *  @brief precomputed per-frame depth statistics
+ *
+ * DepthSummary holds integral images of the number, sum and sum of squares
+ * of the valid (nonzero, non-NaN) depth measurements of a frame, along with
+ * an integral histogram of depth computed over a coarse grid of cells. Once
+ * built, the count, mean, variance and depth histogram of any rectangular
+ * region can be queried in constant time (O(nbins) for the histogram),
+ * independent of the region size. This makes it cheap to compute depth
+ * statistics for every part of every candidate in a frame
+ *
+ * Depth is stored in meters. CV_16U depth images are assumed to be in
+ * millimeters (as produced by Kinect-style sensors) and are converted
+ */
+class DepthSummary {
+private:
+	//! integral image of the number of valid measurements
+	cv::Mat_<int> count_;
+	//! integral image of the sum of valid measurements
+	cv::Mat_<double> sum_;
+	//! integral image of the sum of squares of valid measurements
+	cv::Mat_<double> sqsum_;
+	//! integral histogram over cells, ((cy*(cols+1))+cx)*nbins_ + bin
+	std::vector<int> hist_;
+	//! the size of the depth image
+	cv::Size size_;
+	//! the grid of cells, in cells
+	cv::Size cells_;
+	//! the cell size, in pixels
+	int cellsize_;
+	//! the number of histogram bins
+	int nbins_;
+	//! the depth range spanned by the histogram, in meters
+	float zmin_, zmax_;
+public:
+	DepthSummary() : cellsize_(8), nbins_(64), zmin_(0.3f), zmax_(10.0f) {}
+	/*! @brief construct a summary of a depth image
+	 *
+	 * @see compute()
+	 */
+	DepthSummary(const cv::Mat& depth, int cellsize = 8, int nbins = 64, float zmin = 0.3f, float zmax = 10.0f) {
+		compute(depth, cellsize, nbins, zmin, zmax);
+	}
+	virtual ~DepthSummary() {}
+	void compute(const cv::Mat& depth, int cellsize = 8, int nbins = 64, float zmin = 0.3f, float zmax = 10.0f);
+	//! the size of the summarized depth image
+	cv::Size size(void) const { return size_; }
+	//! whether a depth image has been summarized
+	bool empty(void) const { return count_.empty(); }
+	//! the number of histogram bins
+	int nbins(void) const { return nbins_; }
+	//! the width of a histogram bin, in meters
+	float binWidth(void) const { return (zmax_ - zmin_) / nbins_; }
+	//! the depth at the lower edge of histogram bin b, in meters
+	float binLower(int b) const { return zmin_ + b * binWidth(); }
+	//! the depth at the upper edge of histogram bin b, in meters
+	float binUpper(int b) const { return zmin_ + (b+1) * binWidth(); }
+	int count(const cv::Rect& r) const;
+	double sum(const cv::Rect& r) const;
+	double mean(const cv::Rect& r) const;
+	double variance(const cv::Rect& r) const;
+	void histogram(const cv::Rect& r, std::vector<int>& hist) const;
+};
+
+#endif /* DEPTHSUMMARY_HPP_ */
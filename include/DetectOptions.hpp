@@ -0,0 +1,74 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectOptions.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef DETECTOPTIONS_HPP_
+#define DETECTOPTIONS_HPP_
+#include <vector>
+#include "CancellationToken.hpp"
+#include "DetectStats.hpp"
+
+/*! @class DetectOptions
+ *  @brief per-call options for PartsBasedDetector::detect()
+ *
+ * DetectOptions restricts the work done by a single detection. The default
+ * options search the whole image at every scale
+ */
+class DetectOptions {
+public:
+	//! the smallest object height to search for, in image pixels (0 for no limit)
+	float minObjectSize;
+	//! the largest object height to search for, in image pixels (0 for no limit)
+	float maxObjectSize;
+	//! the pyramid levels to search, indexed as IFeatures::scales(im.size()) (empty for all levels)
+	std::vector<bool> levels;
+	//! the token to poll for cancellation (may be NULL). Not owned
+	const CancellationToken* cancel;
+	/*! the resolution of the input image relative to the original image (eg. 0.25
+	 * for an image decoded at 1/4 scale). Object sizes are given, and candidates
+	 * returned, in original image coordinates */
+	float inputScale;
+	//! filled with the cost of the detection if not NULL (decodeTime is preserved). Not owned
+	DetectStats* stats;
+
+	DetectOptions() : minObjectSize(0), maxObjectSize(0), cancel(NULL), inputScale(1), stats(NULL) {}
+	DetectOptions(float min_object_size, float max_object_size) :
+		minObjectSize(min_object_size), maxObjectSize(max_object_size), cancel(NULL), inputScale(1), stats(NULL) {}
+	//! whether the options restrict the range of object sizes
+	bool restrictsSize(void) const { return minObjectSize > 0 || maxObjectSize > 0; }
+};
+
+#endif /* DETECTOPTIONS_HPP_ */
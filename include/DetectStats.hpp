@@ -0,0 +1,85 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectStats.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef DETECTSTATS_HPP_
+#define DETECTSTATS_HPP_
+#include <cstddef>
+
+/*! @class DetectStats
+ *  @brief the cost of a single detection, stage by stage
+ *
+ * Filled in by PartsBasedDetector::detect() when DetectOptions::stats is set,
+ * and kept for the last detection by DetectionContext::stats(). Times are in
+ * seconds. The detector does not read the image, so decodeTime is left for
+ * the caller to fill in
+ */
+class DetectStats {
+public:
+	//! time to read and decode the image (filled in by the caller)
+	double decodeTime;
+	//! time to compute the feature pyramid
+	double pyramidTime;
+	//! time to prune the search space by depth and convolve the pyramid with the part filters
+	double convolutionTime;
+	//! time to run the dynamic program and backtrack the candidates
+	double dpTime;
+	//! time to suppress non-maximal candidates
+	double nmsTime;
+	//! the number of pyramid levels computed
+	unsigned int levels;
+	//! the number of candidates before non-maxima suppression
+	size_t rawCandidates;
+	//! the number of candidates after non-maxima suppression
+	size_t candidates;
+	//! the bytes held by the pyramid, responses, masks and dynamic program at their peak
+	size_t scratchBytes;
+
+	DetectStats() : decodeTime(0), pyramidTime(0), convolutionTime(0), dpTime(0), nmsTime(0),
+		levels(0), rawCandidates(0), candidates(0), scratchBytes(0) {}
+	//! the total time of all stages
+	double totalTime(void) const { return decodeTime + pyramidTime + convolutionTime + dpTime + nmsTime; }
+	//! add the cost of another pass over the same image (eg. another region). Scratch space is the peak of the two
+	DetectStats& operator+=(const DetectStats& other) {
+		decodeTime += other.decodeTime; pyramidTime += other.pyramidTime; convolutionTime += other.convolutionTime;
+		dpTime += other.dpTime; nmsTime += other.nmsTime; levels += other.levels;
+		rawCandidates += other.rawCandidates; candidates += other.candidates;
+		scratchBytes = (other.scratchBytes > scratchBytes) ? other.scratchBytes : scratchBytes;
+		return *this;
+	}
+};
+
+#endif /* DETECTSTATS_HPP_ */
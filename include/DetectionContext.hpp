@@ -0,0 +1,125 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionContext.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef DETECTIONCONTEXT_HPP_
+#define DETECTIONCONTEXT_HPP_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include "Candidate.hpp"
+#include "CompiledModel.hpp"
+#include "DetectOptions.hpp"
+#include "DynamicProgram.hpp"
+#include "IConvolutionEngine.hpp"
+#include "IFeatures.hpp"
+#include "Parts.hpp"
+#include "SearchSpacePruning.hpp"
+#include "types.hpp"
+
+/*! @class DetectionContext
+ *  @brief the mutable, per-thread state of the detection pipeline
+ *
+ * A DetectionContext runs the detection pipeline against a shared
+ * CompiledModel. It owns everything a detection writes to: the feature
+ * engine (whose scales are updated by every pyramid), the convolution
+ * engine's filter engines (which hold internal row buffers), the search
+ * settings and scratch buffers which are reused from one detection to the
+ * next, whether or not the previous one was cancelled. The filters themselves are only referenced, so a context is cheap
+ * to create and N threads with one context each share one copy of the filters
+ *
+ * A context must only be used by one thread at a time. Use clone() to create
+ * a context for another thread with the same model and settings
+ *
+ * @tparam T the detector precision
+ */
+template<typename T>
+class DetectionContext : private boost::noncopyable {
+private:
+	//! the shared, immutable model
+	boost::shared_ptr<const CompiledModel<T> > model_;
+	//! produces feature pyramids
+	boost::scoped_ptr<IFeatures> features_;
+	//! compares features with Parts
+	boost::scoped_ptr<IConvolutionEngine> convolution_engine_;
+	//! the tree of Parts, sharing the model's filters
+	Parts parts_;
+	//! dynamic program to predict part positions and candidate likelihoods from raw scores
+	DynamicProgram<T> dp_;
+	//! the search space pruner
+	SearchSpacePruning<T> ssp_;
+	//! whether to compute only the pyramid levels consistent with the depth
+	bool depth_scale_selection_;
+	//! the fraction of root locations masked as implausible by depth in the last detection
+	double depth_masked_;
+	//! the cost of the last detection
+	DetectStats stats_;
+	// scratch buffers, reused across detections
+	vectorMat pyramid_;
+	vector2DMat pdf_;
+	vector2DMat masks_;
+	// private methods
+	void search(const vectorMat& pyramid, const CancellationToken* token, int64 start, vectorCandidate& candidates);
+public:
+	explicit DetectionContext(const boost::shared_ptr<const CompiledModel<T> >& model);
+	virtual ~DetectionContext() {}
+	DetectionContext* clone(void) const;
+	void detect(const cv::Mat& im, const cv::Mat& depth, const DetectOptions& options, vectorCandidate& candidates);
+	void detectRaw(const cv::Mat& im, const cv::Mat& depth, const DetectOptions& options, vectorCandidate& candidates);
+	void detectUpdate(const cv::Mat& im, const cv::Mat& changed, const std::vector<cv::Rect>& regions, vectorMat& pyramid, vectorCandidate& candidates);
+	//! the shared model
+	const CompiledModel<T>& model(void) const { return *model_; }
+	//! the scales a pyramid of an image of the given size would have
+	vectorf scales(const cv::Size& imsize) const { return features_->scales(imsize); }
+	int inputReduction(const cv::Size& imsize, const DetectOptions& options);
+	//! suppress non-maximal root scores within a window before backtracking (0 to disable)
+	void setRootSuppression(unsigned int window) { dp_.setRootSuppression(window); }
+	//! prune the search space of RGB-D detections by the physical root width X (meters), focal length fx (pixels) and relative tolerance
+	void setDepthPrior(float X, float fx, float tolerance) { ssp_.setDepthPrior(X, fx, tolerance); }
+	//! compute features, responses and the dynamic program only at scales consistent with the depth histogram (requires a depth prior)
+	void setDepthScaleSelection(bool enable) { depth_scale_selection_ = enable; }
+	//! the fraction of root locations masked as implausible by depth in the last detection. They are still convolved, only never reported
+	double depthMaskedFraction(void) const { return depth_masked_; }
+	//! the cost of the last detection, stage by stage
+	const DetectStats& stats(void) const { return stats_; }
+	//! replace the cost of the last detection, for detections composed of several passes
+	void setStats(const DetectStats& stats) { stats_ = stats; }
+};
+
+#endif /* DETECTIONCONTEXT_HPP_ */
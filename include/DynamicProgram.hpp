@@ -41,6 +41,8 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include "Candidate.hpp"
+#include "CandidateSet.hpp"
+#include "CancellationToken.hpp"
 #include "DistanceTransform.hpp"
 #include "Model.hpp"
 #include "Parts.hpp"
@@ -63,16 +65,21 @@ class DynamicProgram {
 private:
 	//! the threshold for a positive detection
 	double thresh_;
+	//! the window size for suppressing non-maximal root scores (0 to disable)
+	unsigned int nms_window_;
 	DistanceTransform<T> dt_;
 	void distanceTransform1D(const T* src, T* dst, int* ptr, unsigned int n, T a, T b, int os);
 	void distanceTransform1DMat(const cv::Mat_<T>& src, cv::Mat_<T>& dst, cv::Mat_<int>& ptr, unsigned int N, T a, T b, int os);
 public:
-	DynamicProgram() {}
-	DynamicProgram(double thresh) : thresh_(thresh) {}
+	DynamicProgram() : nms_window_(0) {}
+	DynamicProgram(double thresh) : thresh_(thresh), nms_window_(0) {}
 	virtual ~DynamicProgram() {}
+	//! only backtrack from root locations which are maximal within a window of the given size (0 to disable)
+	void setRootSuppression(unsigned int window) { nms_window_ = window; }
 	// public methods
 	void min(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti);
-	void min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, vectorCandidate &candidates);
+	void min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, vectorCandidate &candidates, const vector2DMat& masks = vector2DMat(), const CancellationToken* token = NULL);
+	void min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, CandidateSet &candidates, const vector2DMat& masks = vector2DMat(), const CancellationToken* token = NULL);
 	void argmin(Parts& parts, const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector4DMat& Ix, const vector4DMat& Iy, const vector4DMat& Ik, vectorCandidate& candidates);
 	void distanceTransform(const cv::Mat& score_in, const vectorf w, cv::Point os, cv::Mat& score_out, cv::Mat& Ix, cv::Mat& Iy);
 };
@@ -0,0 +1,96 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    FilterBankCache.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef FILTERBANKCACHE_HPP_
+#define FILTERBANKCACHE_HPP_
+
+#include <string>
+#include <stdint.h>
+#include "types.hpp"
+
+/*! @class FilterBankCache
+ *  @brief sidecar cache of the engine-ready filter bank of a model
+ *
+ * On every model load, the filters are converted to the detector precision
+ * and each is split into flen planes before the convolution engine can use
+ * them. FilterBankCache persists the converted filters and their planes in a
+ * sidecar file so later loads of the same model read them back directly.
+ *
+ * Each cache file is keyed by the identity of the model file it was built
+ * from (its path, size and modification time), the engine precision and the
+ * feature length, so the key costs a stat rather than a pass over the
+ * weights. A cache built from a different or since modified model file, or
+ * for a different detector precision, is rejected and simply rebuilt
+ */
+class FilterBankCache {
+public:
+	//! the current version of the cache format
+	static const unsigned int VERSION = 2;
+	/*! @brief compute the cache key of a model file
+	 *
+	 * @param source the model file the filters were deserialized from
+	 * @param type the precision of the convolution engine
+	 * @param flen the number of planes in each filter
+	 * @return a 64-bit FNV-1a hash of the file path, size, modification
+	 * time, type and flen, or 0 if the file could not be found
+	 */
+	static uint64_t key(const std::string& source, int type, unsigned int flen);
+	/*! @brief read the filters and their planes from a cache file
+	 *
+	 * @param filename the cache file
+	 * @param key the expected key of the cache
+	 * @param type the precision of the convolution engine
+	 * @param flen the number of planes in each filter
+	 * @param filters the converted filters
+	 * @param planes the filter planes, indexed by filter then plane
+	 * @return true if the file exists, is well formed, matches the key and
+	 * holds flen planes of the given type for every filter
+	 */
+	static bool load(const std::string& filename, uint64_t key, int type, unsigned int flen,
+			vectorMat& filters, vector2DMat& planes);
+	/*! @brief write the filters and their planes to a cache file
+	 *
+	 * @param filename the cache file
+	 * @param key the key of the cache
+	 * @param filters the converted filters
+	 * @param planes the filter planes, indexed by filter then plane
+	 * @return true if the file was written
+	 */
+	static bool save(const std::string& filename, uint64_t key, const vectorMat& filters, const vector2DMat& planes);
+};
+
+#endif /* FILTERBANKCACHE_HPP_ */
@@ -69,6 +69,8 @@ private:
 	// private methods
 	void boundaryOcclusionFeature(cv::Mat& feature, const int flen, const int padsize);
 	template<typename IT> void features(const cv::Mat& im, cv::Mat& feature) const;
+	void features(const cv::Mat& im, cv::Mat& feature) const;
+	void images(const cv::Mat& im, const std::vector<bool>& levels, vectorMat& pyraimages) const;
 public:
 	HOGFeatures() {}
 	HOGFeatures(unsigned int binsize, unsigned int nscales, unsigned int flen, unsigned int norient) :
@@ -84,7 +86,11 @@ public:
 	unsigned int binsize(void) const { return binsize_; }
 	unsigned int nscales(void) const { return nscales_; }
 	vectorf scales(void) const { return scales_; }
+	vectorf scales(const cv::Size& imsize) const;
 	void pyramid(const cv::Mat& im, vectorMat& pyrafeatures);
+	void pyramid(const cv::Mat& im, const std::vector<bool>& levels, vectorMat& pyrafeatures, const CancellationToken* token = NULL);
+	void updatePyramid(const cv::Mat& im, const cv::Mat& changed, vectorMat& pyrafeatures);
+	IFeatures* clone(void) const { return new HOGFeatures<T>(*this); }
 };
 
 #endif /* HOGFEATURES_HPP_ */
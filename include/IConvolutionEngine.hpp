@@ -40,6 +40,7 @@
 #define ICONVOLUTIONENGINE_HPP_
 
 #include "types.hpp"
+#include "CancellationToken.hpp"
 
 class IConvolutionEngine {
 public:
@@ -52,8 +53,9 @@ public:
 	 *
 	 * @param features the input pyramid of features
 	 * @param responses a 2D vector of pdfs, 1st dimension across scale, 2nd dimension across filter
+	 * @param token polled between convolution tasks. If cancelled, DetectionCancelled is thrown
 	 */
-	virtual void pdf(const vectorMat& features, vector2DMat& responses) = 0;
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const CancellationToken* token = NULL) = 0;
 
 	/*! @brief set the convolve engine filters
 	 *
@@ -65,6 +67,15 @@ public:
 	 * @param filters the vector of filters
 	 */
 	virtual void setFilters(const vectorMat& filters) = 0;
+
+	/*! @brief create an independent copy of the engine
+	 *
+	 * engines may hold per-call state (eg. filter engines with internal
+	 * buffers), so concurrent detections each need their own copy
+	 *
+	 * @return a new engine with the same filters, owned by the caller
+	 */
+	virtual IConvolutionEngine* clone(void) const = 0;
 };
 
 
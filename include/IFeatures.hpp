@@ -41,6 +41,7 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include "types.hpp"
+#include "CancellationToken.hpp"
 
 /*! @class Feature interface
  *  @brief Interface for creating and comparing image features
@@ -63,6 +64,14 @@ public:
 	 */
 	virtual vectorf scales(void) const = 0;
 
+	/*! @brief the vector of scales a pyramid of an image would have
+	 *
+	 * computes the scales without computing the pyramid, so the levels
+	 * of interest can be selected beforehand
+	 * @param imsize the size of the input image
+	 */
+	virtual vectorf scales(const cv::Size& imsize) const = 0;
+
 	/*! @brief a pyramid of features
 	 *
 	 * features calculated of a number of scales
@@ -70,6 +79,36 @@ public:
 	 * @param pyrafeatures an output vector of matrices of features, one matrix for each scale
 	 */
 	virtual void pyramid(const cv::Mat& im, vectorMat& pyrafeatures) = 0;
+
+	/*! @brief a partial pyramid of features
+	 *
+	 * features calculated only at the selected scales. The output has one
+	 * matrix for every scale, left empty at the scales which were not selected
+	 * @param im the input image to calculate features for
+	 * @param levels the scales to compute, indexed as scales(im.size()). An empty
+	 * vector selects every scale
+	 * @param pyrafeatures an output vector of matrices of features, one matrix for each scale
+	 * @param token polled between levels. If cancelled, DetectionCancelled is thrown
+	 */
+	virtual void pyramid(const cv::Mat& im, const std::vector<bool>& levels, vectorMat& pyrafeatures, const CancellationToken* token = NULL) = 0;
+
+	/*! @brief update the pyramid of features of the previous frame
+	 *
+	 * recomputes only the features affected by changed pixels
+	 * @param im the input image to calculate features for
+	 * @param changed a mask of the pixels which changed since the previous frame
+	 * @param pyrafeatures the pyramid of features of the previous frame, updated in place
+	 */
+	virtual void updatePyramid(const cv::Mat& im, const cv::Mat& changed, vectorMat& pyrafeatures) = 0;
+
+	/*! @brief create an independent copy of the feature engine
+	 *
+	 * computing a pyramid updates the scales held by the engine, so
+	 * concurrent detections each need their own copy
+	 *
+	 * @return a new feature engine, owned by the caller
+	 */
+	virtual IFeatures* clone(void) const = 0;
 };
 
 //IFeatures::~IFeatures() {}
@@ -39,6 +39,9 @@
 #ifndef MATH_HPP_
 #define MATH_HPP_
 
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include <iostream>
@@ -53,19 +56,42 @@ public:
 	virtual ~Math() {}
 
 	/*! @brief return the median value of a matrix
+	 *
+	 * The matrix may be a non-continuous region of interest. CV_16U matrices
+	 * are handled by a counting select (see the uint16_t specialization) and
+	 * never allocate. Other types are partially sorted in a scratch buffer,
+	 * for which median(mat, buffer) allows the storage to be reused
 	 *
 	 * @param mat the input matrix
-	 * @return the median value, of the same precision as the input
+	 * @return the median value (the upper median for an even number of
+	 * elements), of the same precision as the input, or 0 if mat is empty
 	 */
 	template<typename T>
 	static T median(const cv::Mat& mat) {
-		cv::Mat scratch;
-		mat.copyTo(scratch);
-		cv::MatIterator_<T> first = scratch.begin<T>();
-		cv::MatIterator_<T> last  = scratch.end<T>();
-		cv::MatIterator_<T> middle = first + std::distance(first, last)/2;
-		std::nth_element(first, middle, last);
-		std::cerr << scratch << std::endl;
+		std::vector<T> buffer;
+		return median<T>(mat, buffer);
+	}
+
+	/*! @brief return the median value of a matrix, using a reusable buffer
+	 *
+	 * @param mat the input matrix
+	 * @param buffer scratch storage for the elements. Its capacity is retained
+	 * between calls, so repeated calls do not allocate
+	 * @return the median value, of the same precision as the input
+	 */
+	template<typename T>
+	static T median(const cv::Mat& mat, std::vector<T>& buffer) {
+		assert(mat.depth() == cv::DataType<T>::depth && mat.channels() == 1);
+		if (mat.empty()) return 0;
+		const unsigned int M = mat.rows;
+		const unsigned int N = mat.cols;
+		buffer.resize(M*N);
+		for (unsigned int m = 0; m < M; ++m) {
+			const T* mat_ptr = mat.ptr<T>(m);
+			std::copy(mat_ptr, mat_ptr+N, buffer.begin() + m*N);
+		}
+		typename std::vector<T>::iterator middle = buffer.begin() + buffer.size()/2;
+		std::nth_element(buffer.begin(), middle, buffer.end());
 		return *middle;
 	}
 
@@ -184,5 +210,53 @@ public:
 
 };
 
+/*! @brief return the median value of a CV_16U matrix
+ *
+ * Counting select over two 256-bin histograms: the first pass histograms the
+ * high byte of each element to find the high byte of the median, the second
+ * histograms the low byte of the elements sharing that high byte. This is
+ * O(N) and uses no heap storage, which suits 16-bit (eg. Kinect) depth maps
+ *
+ * @param mat the input matrix
+ * @return the median value (the upper median for an even number of elements)
+ */
+template<>
+inline uint16_t Math::median<uint16_t>(const cv::Mat& mat) {
+	assert(mat.depth() == CV_16U && mat.channels() == 1);
+	if (mat.empty()) return 0;
+	const unsigned int M = mat.rows;
+	const unsigned int N = mat.cols;
+	unsigned int k = (M*N)/2;
+	unsigned int hist[256];
+
+	// histogram the high bytes
+	std::fill(hist, hist+256, 0);
+	for (unsigned int m = 0; m < M; ++m) {
+		const uint16_t* mat_ptr = mat.ptr<uint16_t>(m);
+		for (unsigned int n = 0; n < N; ++n) hist[mat_ptr[n] >> 8]++;
+	}
+	unsigned int high = 0;
+	while (k >= hist[high]) k -= hist[high++];
+
+	// histogram the low bytes of the elements in the selected high bin
+	std::fill(hist, hist+256, 0);
+	for (unsigned int m = 0; m < M; ++m) {
+		const uint16_t* mat_ptr = mat.ptr<uint16_t>(m);
+		for (unsigned int n = 0; n < N; ++n) if ((mat_ptr[n] >> 8) == high) hist[mat_ptr[n] & 0xFF]++;
+	}
+	unsigned int low = 0;
+	while (k >= hist[low]) k -= hist[low++];
+	return (uint16_t)((high << 8) | low);
+}
+
+/*! @brief return the median value of a CV_16U matrix
+ *
+ * The counting select does not need a buffer, so it is left untouched
+ */
+template<>
+inline uint16_t Math::median<uint16_t>(const cv::Mat& mat, std::vector<uint16_t>& /*buffer*/) {
+	return median<uint16_t>(mat);
+}
+
 
 #endif /* MATH_HPP_ */
@@ -75,6 +75,8 @@ protected:
 	vector2Di 	parentid_;
 	//! a unique string identifier for the model
 	std::string name_;
+	//! the file the model was deserialized from (empty if none)
+	std::string source_;
 	//! the connectivity of the parts, where each element is a reference to the part's parent
 	vectori conn_;
 	//! the number of parts
@@ -107,6 +109,7 @@ public:
 	vector3Di& defid(void) { return defid_; }
 	vector2Di& parentid(void) { return parentid_; }
 	std::string name(void) { return name_; }
+	const std::string& source(void) const { return source_; }
 	vectori& conn(void) { return conn_; }
 	int nparts(void) const { return nparts_; }
 	int nmixtures(void) const { return nmixtures_; }
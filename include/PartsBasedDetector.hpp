@@ -42,13 +42,12 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include <boost/scoped_ptr.hpp>
-#include "Parts.hpp"
+#include <boost/shared_ptr.hpp>
 #include "Model.hpp"
 #include "Candidate.hpp"
-#include "IFeatures.hpp"
-#include "IConvolutionEngine.hpp"
-#include "DynamicProgram.hpp"
-#include "SearchSpacePruning.hpp"
+#include "CompiledModel.hpp"
+#include "DetectionContext.hpp"
+#include "DetectOptions.hpp"
 
 /*! @mainpage PartsBasedDetector
  *
@@ -146,6 +145,11 @@
  * method distributeModel() for setting up the detector parameters from a deserialized
  * model, and a method detect() for running the detection pipeline.
  *
+ * The distributed model is held in an immutable CompiledModel, and the state
+ * written by each detection in a DetectionContext. To detect on several
+ * threads with a single copy of the filters, give each thread its own context
+ * from createContext()
+ *
  * @tparam T the detector precision. Should be one of float or double. On modern 64-bit
  * machines, the latter will likely be just as fast.
  */
@@ -154,16 +158,12 @@ class PartsBasedDetector {
 private:
 	//! the name of the Part detector
 	std::string name_;
-	//! produces features, feature pyramids and compares features with Parts
-	boost::scoped_ptr<IFeatures> features_;
-	//! compares features with Parts
-	boost::scoped_ptr<IConvolutionEngine> convolution_engine_;
-	//! dynamic program to predict part positions and candidate likelihoods from raw scores
-	DynamicProgram<T> dp_;
-	//! the tree of Parts
-	Parts parts_;
-	//! the search space pruner
-	SearchSpacePruning<T> ssp_;
+	//! the immutable model, shared with any contexts created from the detector
+	boost::shared_ptr<const CompiledModel<T> > model_;
+	//! the detector's own pipeline state
+	boost::scoped_ptr<DetectionContext<T> > context_;
+	// private methods
+	void detectRaw(const cv::Mat& im, const cv::Mat& depth, const DetectOptions& options, std::vector<Candidate>& candidates);
 public:
 	PartsBasedDetector() {}
 	virtual ~PartsBasedDetector() {}
@@ -171,8 +171,34 @@ public:
 	const std::string& name(void) const { return name_; }
 	void detect(const cv::Mat& im, std::vector<Candidate>& candidates);
 	void detect(const cv::Mat& im, const cv::Mat& depth, std::vector<Candidate>& candidates);
+	void detect(const cv::Mat& im, const cv::Mat& depth, const DetectOptions& options, std::vector<Candidate>& candidates);
+	void detect(const cv::Mat& im, const std::vector<cv::Rect>& rois, std::vector<Candidate>& candidates);
+	bool detect(const cv::Mat& im, int64 deadline, std::vector<Candidate>& candidates, std::vector<bool>& covered);
+	void detectBatch(const std::vector<cv::Mat>& images, std::vector<vectorCandidate>& candidates);
+	//! detect in a video frame, updating the caller's pyramid of the previous frame (see DetectionContext::detectUpdate()). Call after distributeModel()
+	void detectUpdate(const cv::Mat& im, const cv::Mat& changed, const std::vector<cv::Rect>& regions, vectorMat& pyramid, std::vector<Candidate>& candidates) {
+		context_->detectUpdate(im, changed, regions, pyramid, candidates);
+	}
 	void distributeModel(Model& model);
 	void distributeModel(Model& model, float threshold);
+	bool distributeModel(Model& model, float threshold, const std::string& cache);
+	//! the shared, immutable model. Call after distributeModel()
+	boost::shared_ptr<const CompiledModel<T> > model(void) const { return model_; }
+	//! a new context with the detector's settings, for use on another thread (owned by the caller). Call after distributeModel()
+	DetectionContext<T>* createContext(void) const { return context_->clone(); }
+	//! the reduction at which an image of the given size can be read for the options (see DetectionContext::inputReduction()). Call after distributeModel()
+	int inputReduction(const cv::Size& imsize, const DetectOptions& options) { return context_->inputReduction(imsize, options); }
+	//! suppress non-maximal root scores within a window before backtracking (0 to disable). Call after distributeModel()
+	void setRootSuppression(unsigned int window) { context_->setRootSuppression(window); }
+	//! prune the search space of RGB-D detections by the physical root width X (meters), focal length fx (pixels) and relative tolerance. Call after distributeModel()
+	void setDepthPrior(float X, float fx, float tolerance) { context_->setDepthPrior(X, fx, tolerance); }
+	//! compute features, responses and the dynamic program only at scales consistent with the depth histogram (requires a depth prior). Call after distributeModel()
+	void setDepthScaleSelection(bool enable) { context_->setDepthScaleSelection(enable); }
+	//! the fraction of root locations masked as implausible by depth in the last detection. They are still convolved, only never reported
+	double depthMaskedFraction(void) const { return context_ ? context_->depthMaskedFraction() : 0; }
+	//! the cost of the last detection, stage by stage. Call after distributeModel()
+	const DetectStats& stats(void) const { return context_->stats(); }
+	size_t footprint(void) const;
 };
 
 #endif /* PARTSBASEDDETECTOR_HPP_ */
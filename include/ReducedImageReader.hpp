@@ -0,0 +1,77 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    ReducedImageReader.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef REDUCEDIMAGEREADER_HPP_
+#define REDUCEDIMAGEREADER_HPP_
+
+#include <string>
+#include <opencv2/core/core.hpp>
+
+/*! @class ReducedImageReader
+ *  @brief reads images at a reduced resolution
+ *
+ * When the smallest object of interest is large, the finest levels of the
+ * feature pyramid are never searched, and decoding the image at full
+ * resolution only to downsample it again is wasted work. JPEG images can be
+ * decoded directly at 1/2, 1/4 or 1/8 of their resolution by scaling in the
+ * DCT domain, which skips most of the inverse transform and color conversion.
+ *
+ * When built with libjpeg (HAVE_JPEG), JPEG files are decoded this way. Other
+ * files, and all files without libjpeg, are decoded at full resolution and
+ * downsampled. Either way the reduced image is ceil(width/denom) by
+ * ceil(height/denom) and each of its pixels spans exactly denom original
+ * pixels, so pass 1/denom as DetectOptions::inputScale to detect in it
+ */
+class ReducedImageReader {
+public:
+	/*! @brief read the size of an image without decoding it
+	 *
+	 * @param filename the image file
+	 * @param size the full resolution size of the image
+	 * @return true if the size could be read from the header alone (JPEG files with libjpeg)
+	 */
+	static bool size(const std::string& filename, cv::Size& size);
+	/*! @brief read a color image at a reduced resolution
+	 *
+	 * @param filename the image file
+	 * @param denom the reduction, one of 1, 2, 4 or 8
+	 * @return the reduced BGR image, or an empty image if the file could not be read
+	 */
+	static cv::Mat read(const std::string& filename, int denom);
+};
+
+#endif /* REDUCEDIMAGEREADER_HPP_ */
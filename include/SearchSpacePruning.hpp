@@ -45,15 +45,44 @@
 #include "Parts.hpp"
 #include "types.hpp"
 
-/*
+/*! @class SearchSpacePruning
+ *  @brief reduce the detection search space using auxiliary information
  *
+ * With a depth image and a known physical object size, the image size of
+ * the object is predictable at every location: an object of width X meters
+ * at depth Z appears fx*X/Z pixels wide. filterResponseByDepth() uses this to
+ * mask the root locations of each scale whose implied metric size is
+ * implausible. Masked roots are never reported as candidates, and a scale
+ * with no plausible root is not convolved at all; the remaining scales are
+ * still convolved and solved in full.
+ * selectScalesByDepth() applies the same reasoning to the depth histogram
+ * of the whole frame to choose which pyramid levels need computing at all
  */
 template<typename T>
 class SearchSpacePruning {
+private:
+	//! the physical width of the root part, in meters (0 to disable)
+	float X_;
+	//! the horizontal focal length of the depth camera, in pixels
+	float fx_;
+	//! the relative tolerance on the implied object size
+	float tolerance_;
 public:
-	SearchSpacePruning() {}
+	SearchSpacePruning() : X_(0), fx_(0), tolerance_(0) {}
 	virtual ~SearchSpacePruning() {}
-	void filterResponseByDepth(vector2DMat& pdfs, const std::vector<cv::Size>& fsizes, const cv::Mat& depth, const vectorf& scales, const float X, const float fx);
+	/*! @brief set the prior on the physical object size
+	 *
+	 * @param X the physical width of the root part, in meters (0 to disable pruning)
+	 * @param fx the horizontal focal length of the camera, in pixels (of the color image)
+	 * @param tolerance the relative deviation from the expected image size that is accepted
+	 */
+	void setDepthPrior(float X, float fx, float tolerance) { X_ = X; fx_ = fx; tolerance_ = tolerance; }
+	//! whether a depth prior has been set
+	bool hasDepthPrior(void) const { return X_ > 0 && fx_ > 0; }
+	void selectScalesBySize(Parts& parts, const vectorf& scales, float minsize, float maxsize, std::vector<bool>& levels) const;
+	void selectScalesByDepth(Parts& parts, const cv::Mat& depth, const vectorf& scales, std::vector<bool>& levels) const;
+	double filterResponseByDepth(Parts& parts, const cv::Mat& depth, const cv::Size& imsize, const std::vector<cv::Size>& fsizes, const vectorf& scales, vector2DMat& masks) const;
+	double filterResponseByRegions(Parts& parts, const std::vector<cv::Rect>& regions, const std::vector<cv::Size>& fsizes, const vectorf& scales, vector2DMat& masks) const;
 	void filterCandidatesByDepth(Parts& parts, vectorCandidate& candidates, const cv::Mat& depth, const float zfactor);
 };
 
@@ -18,12 +18,18 @@ private:
 	int type_;
 	//! the internal representation of the filters
 	vector2DFilterEngine filters_;
+	//! the filters split into planes, indexed by filter then plane
+	vector2DMat planes_;
 	void convolve(const cv::Mat& feature, vectorFilterEngine& filter, cv::Mat& pdf, const unsigned int stride);
 public:
 	SpatialConvolutionEngine(int type, unsigned int flen);
 	virtual ~SpatialConvolutionEngine();
 	virtual void setFilters(const vectorMat& filters);
-	virtual void pdf(const vectorMat& features, vector2DMat& responses);
+	void setFilterPlanes(const vector2DMat& planes);
+	//! the filters split into planes, as used for convolution
+	const vector2DMat& filterPlanes(void) const { return planes_; }
+	virtual void pdf(const vectorMat& features, vector2DMat& responses, const CancellationToken* token = NULL);
+	virtual IConvolutionEngine* clone(void) const;
 };
 
 #endif /* SPATIALCONVOLUTIONENGINE_HPP_ */
@@ -0,0 +1,100 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    VideoDetector.hpp
+ *  Created: Oct 19, 2026
+ */
+
+#ifndef VIDEODETECTOR_HPP_
+#define VIDEODETECTOR_HPP_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "Candidate.hpp"
+#include "PartsBasedDetector.hpp"
+#include "types.hpp"
+
+/*! @class VideoDetector
+ *  @brief incremental detection over a video sequence
+ *
+ * VideoDetector wraps a PartsBasedDetector and exploits the temporal
+ * coherence of video. Keyframes (every keyframe_interval frames, or when
+ * the frame size changes) are searched in full. The feature pyramid is kept
+ * between frames: in between keyframes, only the HOG cells around pixels
+ * which changed significantly are recomputed (via
+ * PartsBasedDetector::detectUpdate()), and only roots whose box touches a
+ * changed region, or a previous candidate overlapping one, are searched.
+ * Candidates from the previous frame which do not intersect any changed
+ * region are carried over unchanged
+ *
+ * The camera is assumed to be static between keyframes. Changes below the
+ * difference threshold are not propagated to the pyramid until the next keyframe
+ *
+ * @tparam T the detector precision
+ */
+template<typename T>
+class VideoDetector {
+private:
+	//! the wrapped detector
+	PartsBasedDetector<T>& detector_;
+	//! the number of frames between full detections
+	unsigned int keyframe_interval_;
+	//! the grey-level difference for a pixel to be considered changed
+	double diff_threshold_;
+	//! the smallest changed region (in pixels) which triggers detection
+	int min_region_area_;
+	//! the number of frames processed since the last reset
+	unsigned int frame_;
+	//! the previous frame, in grayscale
+	cv::Mat previous_;
+	//! the candidates found in the previous frame
+	vectorCandidate previous_candidates_;
+	//! the feature pyramid of the previous frame
+	vectorMat pyramid_;
+	//! whether the last frame was a keyframe
+	bool keyframe_;
+	// private methods
+	void changedRegions(const cv::Mat& gray, cv::Mat& changed, std::vector<cv::Rect>& regions) const;
+public:
+	VideoDetector(PartsBasedDetector<T>& detector, unsigned int keyframe_interval = 10, double diff_threshold = 25, int min_region_area = 64) :
+		detector_(detector), keyframe_interval_(keyframe_interval), diff_threshold_(diff_threshold),
+		min_region_area_(min_region_area), frame_(0), keyframe_(false) {}
+	virtual ~VideoDetector() {}
+	void detect(const cv::Mat& im, vectorCandidate& candidates);
+	//! forget the previous frame, so the next frame is a keyframe
+	void reset(void) { frame_ = 0; previous_.release(); previous_candidates_.clear(); pyramid_.clear(); }
+	//! whether the last call to detect() searched the whole frame
+	bool keyframe(void) const { return keyframe_; }
+};
+
+#endif /* VIDEODETECTOR_HPP_ */
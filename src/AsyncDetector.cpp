@@ -0,0 +1,121 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    AsyncDetector.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include "AsyncDetector.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief start the worker pool
+ *
+ * @param detector the detector to run, with its model already distributed
+ * @param nworkers the number of worker threads (0 for one per hardware thread)
+ * @param capacity the maximum number of images waiting for a worker
+ */
+template<typename T>
+AsyncDetector<T>::AsyncDetector(const PartsBasedDetector<T>& detector, unsigned int nworkers, size_t capacity) :
+	queue_(capacity) {
+
+	if (nworkers == 0) nworkers = max(boost::thread::hardware_concurrency(), 1u);
+	for (unsigned int n = 0; n < nworkers; ++n) {
+		boost::shared_ptr<DetectionContext<T> > context(detector.createContext());
+		workers_.create_thread(boost::bind(&AsyncDetector<T>::work, this, context));
+	}
+}
+
+template<typename T>
+AsyncDetector<T>::~AsyncDetector() {
+	shutdown();
+}
+
+/*! @brief queue an image for detection
+ *
+ * Blocks while the submission queue is full
+ *
+ * @param im the input color or grayscale image
+ * @param options restrictions on the search
+ * @return a future for the non-maximally suppressed candidates. If the detector
+ * has been shut down, or detection fails, the future holds the exception
+ */
+template<typename T>
+boost::unique_future<vectorCandidate> AsyncDetector<T>::submit(const Mat& im, const DetectOptions& options) {
+
+	Job job;
+	job.image = im;
+	job.options = options;
+	job.promise.reset(new boost::promise<vectorCandidate>());
+	if (!queue_.push(job)) {
+		job.promise->set_exception(boost::copy_exception(std::runtime_error("AsyncDetector has been shut down")));
+	}
+	return job.promise->get_future();
+}
+
+/*! @brief stop accepting images, finish the queued ones and join the workers
+ */
+template<typename T>
+void AsyncDetector<T>::shutdown(void) {
+	queue_.close();
+	workers_.join_all();
+}
+
+/*! @brief the worker loop
+ *
+ * @param context the worker's own detection context
+ */
+template<typename T>
+void AsyncDetector<T>::work(boost::shared_ptr<DetectionContext<T> > context) {
+
+	Job job;
+	while (queue_.pop(job)) {
+		try {
+			vectorCandidate candidates;
+			context->detect(job.image, Mat(), job.options, candidates);
+			job.promise->set_value(candidates);
+		} catch (const DetectionCancelled& e) {
+			// rethrown by type, so callers can tell cancellation from failure
+			job.promise->set_exception(boost::copy_exception(e));
+		} catch (...) {
+			job.promise->set_exception(boost::current_exception());
+		}
+		job = Job();
+	}
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class AsyncDetector<float>;
+template class AsyncDetector<double>;
@@ -0,0 +1,402 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    BinaryModel.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <opencv2/core/core.hpp>
+#include "BinaryModel.hpp"
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+/*! @class MappedFile
+ *  @brief a private, copy-on-write mapping of a whole file
+ */
+class MappedFile : private boost::noncopyable {
+private:
+	char* data_;
+	size_t size_;
+#ifdef _WIN32
+	HANDLE file_;
+	HANDLE mapping_;
+#endif
+public:
+#ifdef _WIN32
+	MappedFile() : data_(NULL), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(NULL) {}
+	~MappedFile() {
+		if (data_) UnmapViewOfFile(data_);
+		if (mapping_) CloseHandle(mapping_);
+		if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+	}
+	bool open(const std::string& filename) {
+		file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file_ == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return false;
+		mapping_ = CreateFileMappingA(file_, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		if (!mapping_) return false;
+		data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_COPY, 0, 0, 0));
+		size_ = static_cast<size_t>(size.QuadPart);
+		return data_ != NULL;
+	}
+#else
+	MappedFile() : data_(NULL), size_(0) {}
+	~MappedFile() {
+		if (data_) munmap(data_, size_);
+	}
+	bool open(const std::string& filename) {
+		int fd = ::open(filename.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			::close(fd);
+			return false;
+		}
+		// private and writable, so that a model modified after loading
+		// gets copy-on-write pages rather than a fault or a modified file
+		void* data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) return false;
+		data_ = static_cast<char*>(data);
+		size_ = st.st_size;
+		return true;
+	}
+#endif
+	const char* data(void) const { return data_; }
+	char* data(void) { return data_; }
+	size_t size(void) const { return size_; }
+};
+
+namespace {
+
+//! the alignment of each section, in bytes
+const size_t ALIGNMENT = 64;
+const char MAGIC[8] = { 'D', 'P', 'M', 'B', 'I', 'N', '\0', '\0' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//! the sections of the file, in the order they are written
+enum Section {
+	NAME,			// char
+	FILTERS,		// FilterEntry
+	FILTER_BLOB,	// bytes
+	BIAS,			// float
+	DEF_PTR,		// int32, ndefs+1
+	DEF,			// float
+	ANCHORS,		// int32 (x,y) pairs
+	PART_PTR,		// int32, ncomponents+1
+	PARENTID,		// int32, one per part
+	FILTERID_PTR,	// int32, nparts+1
+	FILTERID,		// int32
+	BIASID_PTR,		// int32, nparts+1
+	BIASID,			// int32
+	DEFID_PTR,		// int32, nparts+1
+	DEFID,			// int32
+	NSECTIONS
+};
+
+struct BinaryHeader {
+	char magic[8];
+	uint32_t byteorder;
+	uint32_t version;
+	int32_t nscales;
+	int32_t binsize;
+	int32_t norient;
+	int32_t flen;
+	float thresh;
+	int32_t reserved;
+	//! (byte offset, element count) of each section
+	uint64_t sections[NSECTIONS][2];
+};
+
+struct FilterEntry {
+	int32_t rows;
+	int32_t cols;
+	int32_t type;
+	int32_t reserved;
+	uint64_t offset;
+};
+
+/*! @brief append a section to the buffer, aligned to ALIGNMENT
+ *
+ * @return the byte offset of the section within the buffer
+ */
+uint64_t append(std::vector<char>& buf, const void* data, size_t bytes) {
+	const size_t offset = (buf.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	buf.resize(offset + bytes, 0);
+	if (bytes) memcpy(&buf[offset], data, bytes);
+	return offset;
+}
+
+template<typename T>
+void appendSection(std::vector<char>& buf, BinaryHeader& header, Section section, const std::vector<T>& data) {
+	header.sections[section][0] = append(buf, data.empty() ? NULL : &data[0], data.size()*sizeof(T));
+	header.sections[section][1] = data.size();
+}
+
+//! flatten a 2D vector into compressed row form
+template<typename T>
+void flatten(const std::vector<std::vector<T> >& in, std::vector<int32_t>& ptr, std::vector<T>& out) {
+	ptr.resize(1, 0);
+	out.clear();
+	for (unsigned int n = 0; n < in.size(); ++n) {
+		out.insert(out.end(), in[n].begin(), in[n].end());
+		ptr.push_back(out.size());
+	}
+}
+
+//! flatten a (component, part, mixture) indexing schema into compressed row form
+void flatten(const vector3Di& in, std::vector<int32_t>& ptr, std::vector<int32_t>& out) {
+	ptr.resize(1, 0);
+	out.clear();
+	for (unsigned int c = 0; c < in.size(); ++c) {
+		for (unsigned int p = 0; p < in[c].size(); ++p) {
+			out.insert(out.end(), in[c][p].begin(), in[c][p].end());
+			ptr.push_back(out.size());
+		}
+	}
+}
+
+/*! @class SectionReader
+ *  @brief bounds checked access to the sections of a mapped file
+ */
+class SectionReader {
+private:
+	const char* base_;
+	size_t size_;
+	const BinaryHeader* header_;
+public:
+	SectionReader(const char* base, size_t size) : base_(base), size_(size),
+		header_(reinterpret_cast<const BinaryHeader*>(base)) {}
+	//! get a pointer to a section and its length, or false if it lies outside the file
+	template<typename T>
+	bool get(Section section, const T*& data, size_t& count) const {
+		const uint64_t offset = header_->sections[section][0];
+		count = header_->sections[section][1];
+		if (offset % ALIGNMENT != 0 || offset > size_ || count > (size_ - offset) / sizeof(T)) return false;
+		data = reinterpret_cast<const T*>(base_ + offset);
+		return true;
+	}
+	//! validate a compressed row pointer against the section it indexes
+	bool validate(const int32_t* ptr, size_t nptr, size_t ndata) const {
+		if (nptr == 0 || ptr[0] != 0 || static_cast<size_t>(ptr[nptr-1]) != ndata) return false;
+		for (size_t n = 1; n < nptr; ++n) if (ptr[n] < ptr[n-1]) return false;
+		return true;
+	}
+	//! get a compressed row section pair, validated
+	template<typename T>
+	bool get(Section psection, Section dsection, const int32_t*& ptr, size_t& nptr, const T*& data) const {
+		size_t ndata;
+		return get(psection, ptr, nptr) && get(dsection, data, ndata) && validate(ptr, nptr, ndata);
+	}
+};
+
+} // namespace
+
+bool BinaryModel::serialize(const std::string& filename) const {
+
+	BinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.byteorder = BYTE_ORDER_MARK;
+	header.version   = VERSION;
+	header.nscales   = nscales_;
+	header.binsize   = binsize_;
+	header.norient   = norient_;
+	header.flen      = flen_;
+	header.thresh    = thresh_;
+
+	// reserve space for the header, then lay out the sections
+	std::vector<char> buf(sizeof(header), 0);
+	appendSection(buf, header, NAME, std::vector<char>(name_.begin(), name_.end()));
+
+	// the filter table and blob
+	const unsigned int nfilters = filtersw_.size();
+	std::vector<FilterEntry> entries(nfilters);
+	std::vector<char> blob;
+	for (unsigned int n = 0; n < nfilters; ++n) {
+		const cv::Mat filter = filtersw_[n].isContinuous() ? filtersw_[n] : filtersw_[n].clone();
+		FilterEntry& entry = entries[n];
+		entry.rows = filter.rows;
+		entry.cols = filter.cols;
+		entry.type = filter.type();
+		entry.reserved = 0;
+		entry.offset = append(blob, filter.data, filter.total()*filter.elemSize());
+	}
+	appendSection(buf, header, FILTERS, entries);
+	appendSection(buf, header, FILTER_BLOB, blob);
+
+	// the weights
+	appendSection(buf, header, BIAS, biasw_);
+	std::vector<int32_t> ptr;
+	std::vector<float> defs;
+	flatten(defw_, ptr, defs);
+	appendSection(buf, header, DEF_PTR, ptr);
+	appendSection(buf, header, DEF, defs);
+	std::vector<int32_t> anchors;
+	for (unsigned int n = 0; n < anchors_.size(); ++n) {
+		anchors.push_back(anchors_[n].x);
+		anchors.push_back(anchors_[n].y);
+	}
+	appendSection(buf, header, ANCHORS, anchors);
+
+	// the indexing tables
+	std::vector<int32_t> ids;
+	flatten(parentid_, ptr, ids);
+	appendSection(buf, header, PART_PTR, ptr);
+	appendSection(buf, header, PARENTID, ids);
+	flatten(filterid_, ptr, ids);
+	appendSection(buf, header, FILTERID_PTR, ptr);
+	appendSection(buf, header, FILTERID, ids);
+	flatten(biasid_, ptr, ids);
+	appendSection(buf, header, BIASID_PTR, ptr);
+	appendSection(buf, header, BIASID, ids);
+	flatten(defid_, ptr, ids);
+	appendSection(buf, header, DEFID_PTR, ptr);
+	appendSection(buf, header, DEFID, ids);
+
+	memcpy(&buf[0], &header, sizeof(header));
+
+	// write out the file
+	std::ofstream fs(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!fs) return false;
+	fs.write(&buf[0], buf.size());
+	return fs.good();
+}
+
+bool BinaryModel::deserialize(const std::string& filename) {
+
+	// map the file
+	boost::shared_ptr<MappedFile> map(new MappedFile);
+	if (!map->open(filename) || map->size() < sizeof(BinaryHeader)) return false;
+
+	// check the header
+	const BinaryHeader& header = *reinterpret_cast<const BinaryHeader*>(map->data());
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+	if (header.byteorder != BYTE_ORDER_MARK || header.version != VERSION) return false;
+	SectionReader reader(map->data(), map->size());
+
+	// read the primitives
+	const char* name;
+	size_t nname;
+	if (!reader.get(NAME, name, nname)) return false;
+	name_.assign(name, nname);
+	nscales_ = header.nscales;
+	binsize_ = header.binsize;
+	norient_ = header.norient;
+	flen_    = header.flen;
+	thresh_  = header.thresh;
+
+	// point the filters at the mapped blob
+	const FilterEntry* entries;
+	const char* blob;
+	size_t nfilters, nblob;
+	if (!reader.get(FILTERS, entries, nfilters) || !reader.get(FILTER_BLOB, blob, nblob)) return false;
+	std::vector<cv::Mat> filters(nfilters);
+	for (size_t n = 0; n < nfilters; ++n) {
+		const FilterEntry& entry = entries[n];
+		if (entry.rows < 0 || entry.cols < 0 || CV_MAT_TYPE(entry.type) != entry.type) return false;
+		const size_t bytes = static_cast<size_t>(entry.rows) * entry.cols * CV_ELEM_SIZE(entry.type);
+		if (entry.offset > nblob || bytes > nblob - entry.offset) return false;
+		filters[n] = cv::Mat(entry.rows, entry.cols, entry.type, const_cast<char*>(blob + entry.offset));
+	}
+
+	// read the weights
+	const float* bias;
+	size_t nbias;
+	if (!reader.get(BIAS, bias, nbias)) return false;
+	const int32_t* defptr;
+	const float* defs;
+	size_t ndefptr;
+	if (!reader.get(DEF_PTR, DEF, defptr, ndefptr, defs)) return false;
+	const int32_t* anchors;
+	size_t nanchors;
+	if (!reader.get(ANCHORS, anchors, nanchors) || nanchors % 2 != 0) return false;
+
+	// read the indexing tables
+	const int32_t *partptr, *parentid, *filteridptr, *filterid, *biasidptr, *biasid, *defidptr, *defid;
+	size_t npartptr, nfilteridptr, nbiasidptr, ndefidptr;
+	if (!reader.get(PART_PTR, PARENTID, partptr, npartptr, parentid)) return false;
+	if (!reader.get(FILTERID_PTR, FILTERID, filteridptr, nfilteridptr, filterid)) return false;
+	if (!reader.get(BIASID_PTR, BIASID, biasidptr, nbiasidptr, biasid)) return false;
+	if (!reader.get(DEFID_PTR, DEFID, defidptr, ndefidptr, defid)) return false;
+	const size_t nparts = partptr[npartptr-1];
+	if (nfilteridptr != nparts+1 || nbiasidptr != nparts+1 || ndefidptr != nparts+1) return false;
+
+	// everything checks out, so commit the model
+	filtersw_.swap(filters);
+	biasw_.assign(bias, bias+nbias);
+	defw_.resize(ndefptr-1);
+	for (size_t n = 0; n < ndefptr-1; ++n) {
+		defw_[n].assign(defs+defptr[n], defs+defptr[n+1]);
+	}
+	anchors_.resize(nanchors/2);
+	for (size_t n = 0; n < nanchors/2; ++n) {
+		anchors_[n] = cv::Point(anchors[2*n], anchors[2*n+1]);
+	}
+	const size_t ncomponents = npartptr-1;
+	parentid_.resize(ncomponents);
+	filterid_.resize(ncomponents);
+	biasid_.resize(ncomponents);
+	defid_.resize(ncomponents);
+	for (size_t c = 0; c < ncomponents; ++c) {
+		const int begin = partptr[c];
+		const int end   = partptr[c+1];
+		parentid_[c].assign(parentid+begin, parentid+end);
+		filterid_[c].resize(end-begin);
+		biasid_[c].resize(end-begin);
+		defid_[c].resize(end-begin);
+		for (int p = begin; p < end; ++p) {
+			filterid_[c][p-begin].assign(filterid+filteridptr[p], filterid+filteridptr[p+1]);
+			biasid_[c][p-begin].assign(biasid+biasidptr[p], biasid+biasidptr[p+1]);
+			defid_[c][p-begin].assign(defid+defidptr[p], defid+defidptr[p+1]);
+		}
+	}
+
+	// keep the mapping alive for as long as the filters refer to it
+	map_ = map;
+	source_ = filename;
+	return true;
+}
@@ -0,0 +1,114 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    CompiledModel.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <opencv2/core/core.hpp>
+#include "CompiledModel.hpp"
+#include "FilterBankCache.hpp"
+using namespace cv;
+
+/*! @brief compile a deserialized model
+ *
+ * The engine-ready filter bank (filters converted to the detector precision
+ * and split into planes) is read from the given sidecar cache if it was
+ * built from the same model file, and otherwise computed and written back to
+ * it, so repeated loads of a model skip the conversion and splitting
+ *
+ * @param model the monolithic model containing the deserialization of all model parameters.
+ * Its filters are replaced by their converted copies
+ * @param threshold the multiplication value to adjust the matching threshold value
+ * @param cache the filter bank cache file (empty for no caching). Ignored if
+ * the model was not deserialized from a file
+ */
+template<typename T>
+CompiledModel<T>::CompiledModel(Model& model, float threshold, const std::string& cache) :
+	name_(model.name()), binsize_(model.binsize()), nscales_(model.nscales()), flen_(model.flen()),
+	norient_(model.norient()), thresh_(model.thresh()*threshold), cached_(false) {
+
+	// try the cached filter bank. The cached filters must have the shapes of
+	// the model's, and then replace them directly
+	const unsigned int nfilters = model.filters().size();
+	const uint64_t key = cache.empty() ? 0 : FilterBankCache::key(model.source(), DataType<T>::type, flen_);
+	if (key != 0) {
+		vectorMat filters;
+		cached_ = FilterBankCache::load(cache, key, DataType<T>::type, flen_, filters, planes_) &&
+				filters.size() == nfilters;
+		for (unsigned int n = 0; cached_ && n < nfilters; ++n) {
+			cached_ = filters[n].size() == model.filters()[n].size();
+		}
+		if (cached_) model.filters().swap(filters);
+	}
+	if (!cached_) {
+		// make sure the filters are of the correct precision for the Feature engine.
+		// Always convert into freshly allocated storage, since the model's filters
+		// may refer to memory owned by the model (eg. a mapped BinaryModel)
+		planes_.assign(nfilters, vectorMat());
+		for (unsigned int n = 0; n < nfilters; ++n) {
+			Mat filter;
+			model.filters()[n].convertTo(filter, DataType<T>::type);
+			model.filters()[n] = filter;
+			split(filter.reshape(flen_), planes_[n]);
+		}
+		if (key != 0) FilterBankCache::save(cache, key, model.filters(), planes_);
+	}
+
+	// initialize the tree of Parts
+	parts_ = Parts(model.filters(), model.filtersi(), model.def(), model.defi(), model.bias(), model.biasi(),
+			model.anchors(), model.biasid(), model.filterid(), model.defid(), model.parentid());
+}
+
+/*! @brief the approximate memory held by the model
+ *
+ * dominated by the filters, which are held once by the Parts and once
+ * split into planes. Each DetectionContext additionally holds a copy of the
+ * planes within its filter engines
+ *
+ * @return the footprint, in bytes
+ */
+template<typename T>
+size_t CompiledModel<T>::footprint(void) const {
+
+	size_t bytes = 0;
+	const vectorMat& filters = parts_.filters();
+	for (unsigned int n = 0; n < filters.size(); ++n) {
+		bytes += filters[n].total() * filters[n].elemSize();
+	}
+	return 2*bytes + sizeof(*this);
+}
+
+// declare all specializations of the template
+template class CompiledModel<float>;
+template class CompiledModel<double>;
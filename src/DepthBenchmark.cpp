@@ -0,0 +1,193 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DepthBenchmark.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <opencv2/core/core.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include "Candidate.hpp"
+#include "FileStorageModel.hpp"
+#include "Math.hpp"
+#include "Parts.hpp"
+#include "SearchSpacePruning.hpp"
+#include "types.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief the median as originally computed, for reference
+ *
+ * copies the region into a freshly allocated matrix and selects the median
+ * with nth_element
+ */
+template<typename T>
+static T referenceMedian(const Mat& im) {
+	Mat vec = im.clone().reshape(0, 1);
+	if (vec.empty()) return 0;
+	T* begin = vec.ptr<T>(0);
+	T* end   = begin + vec.cols;
+	T* mid   = begin + vec.cols/2;
+	std::nth_element(begin, mid, end);
+	return *mid;
+}
+
+/*! @brief generate a synthetic Kinect-sized depth frame in millimetres
+ *
+ * a sloping floor with a few box-shaped objects, sensor noise and
+ * holes (zero depth) where the structured light failed
+ */
+static Mat syntheticDepth(RNG& rng) {
+	Mat_<uint16_t> depth(480, 640);
+	for (int y = 0; y < depth.rows; ++y) {
+		for (int x = 0; x < depth.cols; ++x) {
+			depth(y,x) = saturate_cast<uint16_t>(4000 - 4*y + rng.gaussian(8.0));
+		}
+	}
+	for (int n = 0; n < 8; ++n) {
+		Rect r(rng.uniform(0, 560), rng.uniform(0, 320), rng.uniform(20, 80), rng.uniform(40, 160));
+		depth(r & Rect(0, 0, depth.cols, depth.rows)).setTo(rng.uniform(800, 3500));
+	}
+	for (int n = 0; n < 4000; ++n) {
+		depth(rng.uniform(0, depth.rows), rng.uniform(0, depth.cols)) = 0;
+	}
+	return depth;
+}
+
+/*! @brief generate random candidates with the part layout of the given model
+ *
+ * parts are placed at their anchor offsets from the root, which is placed
+ * uniformly at random in the frame
+ */
+static void syntheticCandidates(Parts& parts, const Size& size, int N, RNG& rng, vectorCandidate& candidates) {
+	candidates.clear();
+	for (int n = 0; n < N; ++n) {
+		const int c = rng.uniform(0, (int)parts.ncomponents());
+		const int nparts = parts.nparts(c);
+		const int w = rng.uniform(8, 24);
+		vector<Point> centres(nparts);
+		centres[0] = Point(rng.uniform(0, size.width), rng.uniform(0, size.height));
+		Candidate candidate;
+		candidate.setComponent(c);
+		for (int p = 0; p < nparts; ++p) {
+			ComponentPart part = parts.component(c,p);
+			if (p > 0) centres[p] = centres[part.parent().self()] + part.anchor(0)*2;
+			candidate.addPart(Rect(centres[p].x - w/2, centres[p].y - w/2, w, w), 0);
+		}
+		candidates.push_back(candidate);
+	}
+}
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc != 2 && argc != 3) {
+		printf("Usage: DepthBenchmark model_file [ncandidates]\n");
+		exit(-1);
+	}
+	const int N = (argc == 3) ? atoi(argv[2]) : 1000;
+
+	// load the model
+	boost::scoped_ptr<Model> model;
+	string ext = boost::filesystem::path(argv[1]).extension().string();
+	if (ext.compare(".xml") == 0 || ext.compare(".yaml") == 0) {
+		model.reset(new FileStorageModel);
+	} else {
+		printf("Unsupported model format: %s\n", ext.c_str());
+		exit(-2);
+	}
+	if (!model->deserialize(argv[1])) {
+		printf("Error deserializing file\n");
+		exit(-3);
+	}
+	Parts parts(model->filters(), model->filtersi(), model->def(), model->defi(), model->bias(), model->biasi(),
+			model->anchors(), model->biasid(), model->filterid(), model->defid(), model->parentid());
+
+	RNG rng(0xdeadbeef);
+	Mat depth16 = syntheticDepth(rng);
+	Mat depth32;
+	depth16.convertTo(depth32, CV_32F, 1.0/1000.0);
+
+	// median of individual boxes
+	const int NBOXES = 20000;
+	vector<Rect> boxes(NBOXES);
+	for (int n = 0; n < NBOXES; ++n) {
+		int w = rng.uniform(8, 64);
+		int h = rng.uniform(8, 64);
+		boxes[n] = Rect(rng.uniform(0, depth16.cols-w), rng.uniform(0, depth16.rows-h), w, h);
+	}
+	vectorf fbuf;
+	double checksum[4] = {0, 0, 0, 0};
+	double t[4];
+	t[0] = (double)getTickCount();
+	for (int n = 0; n < NBOXES; ++n) checksum[0] += referenceMedian<uint16_t>(depth16(boxes[n]));
+	t[0] = ((double)getTickCount() - t[0])/getTickFrequency();
+	t[1] = (double)getTickCount();
+	for (int n = 0; n < NBOXES; ++n) checksum[1] += Math::median<uint16_t>(depth16(boxes[n]));
+	t[1] = ((double)getTickCount() - t[1])/getTickFrequency();
+	t[2] = (double)getTickCount();
+	for (int n = 0; n < NBOXES; ++n) checksum[2] += referenceMedian<float>(depth32(boxes[n]));
+	t[2] = ((double)getTickCount() - t[2])/getTickFrequency();
+	t[3] = (double)getTickCount();
+	for (int n = 0; n < NBOXES; ++n) checksum[3] += Math::median<float>(depth32(boxes[n]), fbuf);
+	t[3] = ((double)getTickCount() - t[3])/getTickFrequency();
+	printf("Median of %d boxes:\n", NBOXES);
+	printf("  CV_16U  reference: %8.2f us/box  histogram:   %8.2f us/box  (checksum %s)\n",
+			t[0]*1e6/NBOXES, t[1]*1e6/NBOXES, checksum[0] == checksum[1] ? "ok" : "MISMATCH");
+	printf("  CV_32F  reference: %8.2f us/box  quickselect: %8.2f us/box  (checksum %s)\n",
+			t[2]*1e6/NBOXES, t[3]*1e6/NBOXES, checksum[2] == checksum[3] ? "ok" : "MISMATCH");
+
+	// whole-candidate depth filtering
+	SearchSpacePruning<float> ssp;
+	vectorCandidate candidates;
+	syntheticCandidates(parts, depth16.size(), N, rng, candidates);
+	vectorCandidate filtered = candidates;
+	double t16 = (double)getTickCount();
+	ssp.filterCandidatesByDepth(parts, filtered, depth16, 30.0f);
+	t16 = ((double)getTickCount() - t16)/getTickFrequency();
+	const size_t kept16 = filtered.size();
+	filtered = candidates;
+	double t32 = (double)getTickCount();
+	ssp.filterCandidatesByDepth(parts, filtered, depth32, 0.03f);
+	t32 = ((double)getTickCount() - t32)/getTickFrequency();
+	printf("Depth filtering of %d candidates:\n", N);
+	printf("  CV_16U: %8.3f ms (%8.0f candidates/s, %ld kept)\n", t16*1e3, N/t16, (long)kept16);
+	printf("  CV_32F: %8.3f ms (%8.0f candidates/s, %ld kept)\n", t32*1e3, N/t32, (long)filtered.size());
+	return 0;
+}
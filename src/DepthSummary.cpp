@@ -0,0 +1,169 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DepthSummary.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
+#include "DepthSummary.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief summarize a depth image
+ *
+ * @param depth the depth image, either CV_16U (millimeters) or CV_32F/CV_64F (meters)
+ * @param cellsize the side length of the histogram cells, in pixels. Histogram
+ * queries are resolved to the nearest cell boundary
+ * @param nbins the number of histogram bins
+ * @param zmin the lower edge of the first histogram bin, in meters
+ * @param zmax the upper edge of the last histogram bin, in meters. Valid
+ * measurements outside [zmin, zmax) are accumulated into the end bins
+ */
+void DepthSummary::compute(const Mat& depth, int cellsize, int nbins, float zmin, float zmax) {
+
+	CV_Assert(depth.channels() == 1 && cellsize > 0 && nbins > 0 && zmax > zmin);
+	cellsize_ = cellsize;
+	nbins_ = nbins;
+	zmin_ = zmin;
+	zmax_ = zmax;
+	size_ = depth.size();
+	cells_ = Size((size_.width + cellsize-1) / cellsize, (size_.height + cellsize-1) / cellsize);
+
+	// convert to meters, zeroing invalid measurements
+	Mat_<float> z;
+	depth.convertTo(z, CV_32F, depth.depth() == CV_16U ? 1.0/1000.0 : 1.0);
+	Mat_<uchar> valid(size_);
+	const int M = size_.height;
+	const int N = size_.width;
+	for (int m = 0; m < M; ++m) {
+		float* z_ptr = z[m];
+		uchar* valid_ptr = valid[m];
+		for (int n = 0; n < N; ++n) {
+			const bool v = z_ptr[n] > 0 && !boost::math::isnan(z_ptr[n]);
+			valid_ptr[n] = v;
+			if (!v) z_ptr[n] = 0;
+		}
+	}
+
+	// integral images of the count, sum and sum of squares
+	integral(valid, count_, CV_32S);
+	integral(z, sum_, sqsum_, CV_64F);
+
+	// histogram each cell, then integrate over cells
+	const int W = cells_.width + 1;
+	const int K = nbins_;
+	const float scale = nbins_ / (zmax_ - zmin_);
+	hist_.assign((cells_.height+1) * W * K, 0);
+	for (int m = 0; m < M; ++m) {
+		const float* z_ptr = z[m];
+		const uchar* valid_ptr = valid[m];
+		int* row_ptr = &hist_[((m/cellsize_ + 1) * W + 1) * K];
+		for (int n = 0; n < N; ++n) {
+			if (!valid_ptr[n]) continue;
+			const int b = std::min(std::max((int)((z_ptr[n] - zmin_) * scale), 0), K-1);
+			row_ptr[(n/cellsize_) * K + b]++;
+		}
+	}
+	for (int cy = 1; cy <= cells_.height; ++cy) {
+		for (int cx = 1; cx <= cells_.width; ++cx) {
+			int* h   = &hist_[(cy*W + cx) * K];
+			int* hu  = &hist_[((cy-1)*W + cx) * K];
+			int* hl  = &hist_[(cy*W + cx-1) * K];
+			int* hul = &hist_[((cy-1)*W + cx-1) * K];
+			for (int b = 0; b < K; ++b) h[b] += hu[b] + hl[b] - hul[b];
+		}
+	}
+}
+
+//! the number of valid depth measurements within a region
+int DepthSummary::count(const Rect& roi) const {
+	const Rect r = roi & Rect(Point(0,0), size_);
+	if (r.area() == 0) return 0;
+	return count_(r.y, r.x) + count_(r.y+r.height, r.x+r.width) - count_(r.y, r.x+r.width) - count_(r.y+r.height, r.x);
+}
+
+//! the sum of valid depth measurements within a region, in meters
+double DepthSummary::sum(const Rect& roi) const {
+	const Rect r = roi & Rect(Point(0,0), size_);
+	if (r.area() == 0) return 0;
+	return sum_(r.y, r.x) + sum_(r.y+r.height, r.x+r.width) - sum_(r.y, r.x+r.width) - sum_(r.y+r.height, r.x);
+}
+
+//! the mean of valid depth measurements within a region, or 0 if there are none
+double DepthSummary::mean(const Rect& roi) const {
+	const int n = count(roi);
+	return n > 0 ? sum(roi) / n : 0;
+}
+
+//! the variance of valid depth measurements within a region, or 0 if there are none
+double DepthSummary::variance(const Rect& roi) const {
+	const Rect r = roi & Rect(Point(0,0), size_);
+	const int n = count(r);
+	if (n == 0) return 0;
+	const double sq = sqsum_(r.y, r.x) + sqsum_(r.y+r.height, r.x+r.width) - sqsum_(r.y, r.x+r.width) - sqsum_(r.y+r.height, r.x);
+	const double mu = sum(r) / n;
+	return std::max(sq / n - mu*mu, 0.0);
+}
+
+/*! @brief the depth histogram of a region
+ *
+ * The region is snapped to the nearest cell boundaries (covering at least one
+ * cell), so the histogram is approximate for regions that are not aligned
+ * to the cell grid
+ *
+ * @param roi the region of interest
+ * @param hist the output histogram, of length nbins()
+ */
+void DepthSummary::histogram(const Rect& roi, vector<int>& hist) const {
+	hist.assign(nbins_, 0);
+	const Rect r = roi & Rect(Point(0,0), size_);
+	if (r.area() == 0) return;
+	const int half = cellsize_ / 2;
+	int x0 = std::min((r.x + half) / cellsize_, cells_.width-1);
+	int y0 = std::min((r.y + half) / cellsize_, cells_.height-1);
+	int x1 = std::min((r.x + r.width  + half) / cellsize_, cells_.width);
+	int y1 = std::min((r.y + r.height + half) / cellsize_, cells_.height);
+	if (x1 <= x0) x1 = x0+1;
+	if (y1 <= y0) y1 = y0+1;
+
+	const int W = cells_.width + 1;
+	const int K = nbins_;
+	const int* h00 = &hist_[(y0*W + x0) * K];
+	const int* h01 = &hist_[(y0*W + x1) * K];
+	const int* h10 = &hist_[(y1*W + x0) * K];
+	const int* h11 = &hist_[(y1*W + x1) * K];
+	for (int b = 0; b < K; ++b) hist[b] = h11[b] - h01[b] - h10[b] + h00[b];
+}
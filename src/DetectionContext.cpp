@@ -0,0 +1,289 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    DetectionContext.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <algorithm>
+#include "DetectionContext.hpp"
+#include "HOGFeatures.hpp"
+#include "SpatialConvolutionEngine.hpp"
+using namespace cv;
+using namespace std;
+
+//! the bytes held by a matrix
+static size_t bytes(const Mat& m) { return m.total() * m.elemSize(); }
+
+//! the bytes held by a (nested) vector of matrices
+template<typename V>
+static size_t bytes(const vector<V>& v) {
+	size_t total = 0;
+	for (unsigned int n = 0; n < v.size(); ++n) total += bytes(v[n]);
+	return total;
+}
+
+/*! @brief create a context for a compiled model
+ *
+ * builds the feature engine and the filter engines over the model's filter
+ * planes. The filter weights are shared with the model, not copied
+ *
+ * @param model the shared model
+ */
+template<typename T>
+DetectionContext<T>::DetectionContext(const boost::shared_ptr<const CompiledModel<T> >& model) :
+	model_(model), parts_(model->parts()), dp_(model->thresh()),
+	depth_scale_selection_(false), depth_masked_(0) {
+
+	features_.reset(new HOGFeatures<T>(model->binsize(), model->nscales(), model->flen(), model->norient()));
+	SpatialConvolutionEngine* engine = new SpatialConvolutionEngine(DataType<T>::type, model->flen());
+	convolution_engine_.reset(engine);
+	engine->setFilterPlanes(model->planes());
+}
+
+/*! @brief create a context for another thread
+ *
+ * @return a new context on the same model with the same settings, owned by the caller
+ */
+template<typename T>
+DetectionContext<T>* DetectionContext<T>::clone(void) const {
+	DetectionContext<T>* context = new DetectionContext<T>(model_);
+	context->dp_ = dp_;
+	context->ssp_ = ssp_;
+	context->depth_scale_selection_ = depth_scale_selection_;
+	return context;
+}
+
+/*! @brief run the detection pipeline
+ *
+ * @param im the input color or grayscale image, at options.inputScale of the original resolution
+ * @param depth the depth image, at the resolution of im (may be empty)
+ * @param options restrictions on the search
+ * @param candidates the output vector of non-maximally suppressed candidates, in original image coordinates
+ * @throws DetectionCancelled if options.cancel is cancelled before detection completes
+ */
+template<typename T>
+void DetectionContext<T>::detect(const Mat& im, const Mat& depth, const DetectOptions& options, vectorCandidate& candidates) {
+
+	detectRaw(im, depth, options, candidates);
+	const int64 t = getTickCount();
+	Candidate::nonMaximaSuppression(im, candidates, 0.4);
+	stats_.nmsTime = (getTickCount() - t) / getTickFrequency();
+	stats_.candidates = candidates.size();
+
+	// map the candidates of a reduced image back to the original image
+	if (options.inputScale != 1) {
+		for (unsigned int n = 0; n < candidates.size(); ++n) candidates[n].resize(1.0f / options.inputScale);
+	}
+
+	// report the cost, keeping the caller's decode time
+	if (options.stats) {
+		const double decode = options.stats->decodeTime;
+		*options.stats = stats_;
+		options.stats->decodeTime = decode;
+	}
+}
+
+/*! @brief the largest reduction at which an image can be read without losing a searched pyramid level
+ *
+ * The pyramid of an image reduced by 2^k is the pyramid of the full image
+ * from level k*interval onwards. If the minimum object size excludes the
+ * first k octaves, the image can be decoded at 1/2^k of its resolution
+ * (see ReducedImageReader) and detected with options.inputScale = 1/2^k
+ * with approximately the same result. JPEG scaling in the DCT domain does
+ * not filter exactly like the pyramid's resize, so scores and boxes differ
+ * slightly. ReducedReadCheck requires every candidate of the full image to
+ * match one of the reduced image one to one, at an intersection over union
+ * of at least 0.5, and reports the score differences
+ *
+ * @param imsize the full resolution size of the image
+ * @param options restrictions on the search, with object sizes in original image pixels
+ * @return the reduction, one of 1, 2, 4 or 8
+ */
+template<typename T>
+int DetectionContext<T>::inputReduction(const Size& imsize, const DetectOptions& options) {
+
+	if (options.minObjectSize <= 0 || !options.levels.empty()) return 1;
+	const vectorf scales = features_->scales(imsize);
+	std::vector<bool> selected;
+	ssp_.selectScalesBySize(parts_, scales, options.minObjectSize, options.maxObjectSize, selected);
+	const unsigned int first = std::find(selected.begin(), selected.end(), true) - selected.begin();
+	if (first == selected.size()) return 1;
+	return 1 << std::min<unsigned int>(first / model_->nscales(), 3);
+}
+
+/*! @brief run the detection pipeline up to (but not including) non-maxima suppression
+ *
+ * @param im the input color or grayscale image
+ * @param depth the depth image (may be empty)
+ * @param options restrictions on the search
+ * @param candidates the output vector of raw detection candidates above the threshold
+ * @throws DetectionCancelled if options.cancel is cancelled before detection completes
+ */
+template<typename T>
+void DetectionContext<T>::detectRaw(const Mat& im, const Mat& depth, const DetectOptions& options, vectorCandidate& candidates) {
+
+	CancellationToken::check(options.cancel);
+	const unsigned int flen = model_->flen();
+	const double freq = getTickFrequency();
+	stats_ = DetectStats();
+	int64 t = getTickCount();
+
+	// select the requested pyramid levels consistent with the object size
+	// range and, optionally, the depth histogram
+	std::vector<bool> levels = options.levels;
+	const bool by_depth = depth_scale_selection_ && !depth.empty() && ssp_.hasDepthPrior();
+	if (options.restrictsSize() || by_depth) {
+		const vectorf scales = features_->scales(im.size());
+		if (levels.empty()) levels.assign(scales.size(), true);
+		std::vector<bool> selected;
+		if (options.restrictsSize()) {
+			// object sizes are in original image pixels
+			const float minsize = options.minObjectSize * options.inputScale;
+			const float maxsize = options.maxObjectSize * options.inputScale;
+			ssp_.selectScalesBySize(parts_, scales, minsize, maxsize, selected);
+			for (unsigned int n = 0; n < levels.size(); ++n) levels[n] = levels[n] && selected[n];
+		}
+		if (by_depth) {
+			ssp_.selectScalesByDepth(parts_, depth, scales, selected);
+			for (unsigned int n = 0; n < levels.size(); ++n) levels[n] = levels[n] && selected[n];
+		}
+	}
+
+	// calculate a feature pyramid for the new image at the selected levels
+	features_->pyramid(im, levels, pyramid_, options.cancel);
+	for (unsigned int n = 0; n < pyramid_.size(); ++n) stats_.levels += !pyramid_[n].empty();
+	stats_.pyramidTime = (getTickCount() - t) / freq;
+	t = getTickCount();
+
+	// restrict the search space to locations of plausible size given the depth
+	masks_.clear();
+	depth_masked_ = 0;
+	if (!depth.empty() && ssp_.hasDepthPrior()) {
+		const unsigned int N = pyramid_.size();
+		vector<Size> fsizes(N);
+		for (unsigned int n = 0; n < N; ++n) fsizes[n] = Size(pyramid_[n].cols / flen, pyramid_[n].rows);
+		depth_masked_ = ssp_.filterResponseByDepth(parts_, depth, im.size(), fsizes, features_->scales(), masks_);
+	}
+
+	search(pyramid_, options.cancel, t, candidates);
+}
+
+/*! @brief detect in a video frame, reusing the feature pyramid of the previous frame
+ *
+ * The caller keeps the pyramid between frames. Only the features around the
+ * changed pixels are recomputed (see IFeatures::updatePyramid()), and only
+ * roots whose bounding box touches one of the regions are searched. Levels
+ * without such roots are neither convolved nor searched
+ *
+ * @param im the input color or grayscale image
+ * @param changed a mask of the pixels which changed since the frame the
+ * pyramid was computed from. If empty, the pyramid is computed from scratch
+ * @param regions the regions to search, in image coordinates
+ * @param pyramid the feature pyramid of the previous frame, updated in place
+ * @param candidates the output vector of non-maximally suppressed candidates
+ */
+template<typename T>
+void DetectionContext<T>::detectUpdate(const Mat& im, const Mat& changed, const vector<Rect>& regions, vectorMat& pyramid, vectorCandidate& candidates) {
+
+	const unsigned int flen = model_->flen();
+	stats_ = DetectStats();
+	int64 t = getTickCount();
+
+	// bring the pyramid up to date with the frame
+	if (changed.empty()) features_->pyramid(im, pyramid);
+	else features_->updatePyramid(im, changed, pyramid);
+	for (unsigned int n = 0; n < pyramid.size(); ++n) stats_.levels += !pyramid[n].empty();
+	stats_.pyramidTime = (getTickCount() - t) / getTickFrequency();
+	t = getTickCount();
+
+	// restrict the search to roots touching the regions
+	const unsigned int N = pyramid.size();
+	vector<Size> fsizes(N);
+	for (unsigned int n = 0; n < N; ++n) fsizes[n] = Size(pyramid[n].cols / flen, pyramid[n].rows);
+	depth_masked_ = 0;
+	ssp_.filterResponseByRegions(parts_, regions, fsizes, features_->scales(), masks_);
+	search(pyramid, NULL, t, candidates);
+
+	t = getTickCount();
+	Candidate::nonMaximaSuppression(im, candidates, 0.4);
+	stats_.nmsTime = (getTickCount() - t) / getTickFrequency();
+	stats_.candidates = candidates.size();
+}
+
+/*! @brief convolve a feature pyramid with the parts and run the dynamic program
+ *
+ * Scales at which masks_ leaves no root location are skipped. The pyramid
+ * itself is not modified, as it may belong to the caller
+ *
+ * @param pyramid the feature pyramid (levels may be empty)
+ * @param token polled between convolution and dynamic program tasks
+ * @param start the tick count at which the convolution stage started
+ * @param candidates the output vector of raw detection candidates above the threshold
+ */
+template<typename T>
+void DetectionContext<T>::search(const vectorMat& pyramid, const CancellationToken* token, int64 start, vectorCandidate& candidates) {
+
+	const double freq = getTickFrequency();
+
+	// drop the scales with no plausible locations
+	vectorMat active(pyramid);
+	for (unsigned int n = 0; n < masks_.size() && n < active.size(); ++n) {
+		if (active[n].empty()) continue;
+		bool plausible = false;
+		for (unsigned int c = 0; c < masks_[n].size() && !plausible; ++c) plausible = countNonZero(masks_[n][c]) > 0;
+		if (!plausible) active[n].release();
+	}
+
+	// convolve the feature pyramid with the Part experts
+	// to get probability density for each Part. The responses of the
+	// previous detection are overwritten in place where their size matches
+	convolution_engine_->pdf(active, pdf_, token);
+	stats_.convolutionTime = (getTickCount() - start) / freq;
+	int64 t = getTickCount();
+
+	// use dynamic programming to predict the best detection candidates from the part responses
+	vector4DMat Ix, Iy, Ik;
+	vector2DMat rootv, rooti;
+	dp_.min_with_backtracking(parts_, pdf_, Ix, Iy, Ik, rootv, rooti, features_->scales(), candidates, masks_, token);
+	stats_.dpTime = (getTickCount() - t) / freq;
+	stats_.rawCandidates = candidates.size();
+
+	// every buffer of the detection is still held here, so this is the peak
+	stats_.scratchBytes = bytes(pyramid) + bytes(pdf_) + bytes(masks_) +
+			bytes(Ix) + bytes(Iy) + bytes(Ik) + bytes(rootv) + bytes(rooti);
+}
+
+// declare all specializations of the template
+template class DetectionContext<float>;
+template class DetectionContext<double>;
@@ -40,6 +40,7 @@
 #include <iostream>
 #include <limits>
 #include "Math.hpp"
+#include "nms.hpp"
 #include "DynamicProgram.hpp"
 using namespace cv;
 using namespace std;
@@ -47,7 +48,7 @@ using namespace std;
 namespace
 {
 template<typename T>
-void backtrack(int n, int c, double thresh_, Parts& parts, const vector2DMat& rootv, const vector2DMat& rooti, const vectorf scales, const vector2DMat& Ixnc, const vector2DMat& Iync, const vector2DMat& Iknc, vectorCandidate& candidates) {
+void backtrack(int n, int c, double thresh_, unsigned int nms_window, Parts& parts, const vector2DMat& rootv, const vector2DMat& rooti, const vectorf& scales, const vector2DMat& Ixnc, const vector2DMat& Iync, const vector2DMat& Iknc, CandidateSet& candidates) {
     T scale = scales[n];
 
     // get the scores and indices for this tree of parts
@@ -56,15 +57,24 @@ void backtrack(int n, int c, double thresh_, Parts& parts, const vector2DMat& ro
     // threshold the root score
     Mat over_thresh = rootv[n][c] > thresh_;
     Mat rootmix     = rooti[n][c];
+
+    // optionally keep only the local maxima of the root score
+    if (nms_window > 0) {
+        Mat maxima;
+        nonMaximaSuppression(rootv[n][c], nms_window, maxima, over_thresh);
+        over_thresh = maxima;
+    }
     vectorPoint inds;
     Math::find(over_thresh, inds);
 
+    // scratch space, reused for every candidate
+    vectori     xv(nparts);
+    vectori     yv(nparts);
+    vectori     mv(nparts);
+    vector<Rect> boxes(nparts);
+    candidates.grow(inds.size(), nparts);
+
     for (unsigned int i = 0; i < inds.size(); ++i) {
-        Candidate candidate;
-        candidate.setComponent(c);
-        vectori     xv(nparts);
-        vectori     yv(nparts);
-        vectori     mv(nparts);
         for (unsigned int p = 0; p < nparts; ++p) {
             ComponentPart part = parts.component(c, p);
             // calculate the child's points from the parent's points
@@ -83,27 +93,64 @@ void backtrack(int n, int c, double thresh_, Parts& parts, const vector2DMat& ro
                 mv[p] = Iknc[p][m].at<int>(y,x);
             }
 
-            // calculate the bounding rectangle and add it to the Candidate
+            // calculate the bounding rectangle of the part
             Point pone = Point(1,1);
             Point xy1 = (Point(xv[p],yv[p])-pone)*scale;
             Point xy2 = xy1 + Point(part.xsize(mv[p]), part.ysize(mv[p]))*scale - pone;
-            if (part.isRoot()) 
-              candidate.addPart(Rect(xy1, xy2), rootv[n][c].at<T>(inds[i]));
-            else
-              candidate.addPart(Rect(xy1, xy2), 0.0);
-        }
-        #ifdef _OPENMP
-        #pragma omp critical(addcandidate)
-        #endif
-        {
-            candidates.push_back(candidate);
+            boxes[p] = Rect(xy1, xy2);
         }
+        candidates.append(rootv[n][c].at<T>(inds[i]), c, &boxes[0], nparts);
     }
 }
 }
 
+/*! @brief Get the min of a dynamic program and backtrack the candidates in one pass
+ *
+ * Equivalent to calling min() followed by argmin(), except that the candidates of
+ * each (scale, component) pair are backtracked as soon as its root scores are
+ * known, so the per-part index matrices never need to be stored for the whole
+ * pyramid. Ix, Iy and Ik are therefore left untouched
+ *
+ * @param parts the parts tree, referenced by the root
+ * @param scores the probability densities (pdfs) of part locations (fine to coarse)
+ * @param rootv the root scores, across scale
+ * @param rooti the root indices, across scale
+ * @param scales the scales (used to calculate bounding box size)
+ * @param candidates the output vector of candidates
+ * @param masks optional per-(scale, component) masks of valid root locations
+ * @param token polled between tasks (may be NULL)
+ */
+template<typename T>
+void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, vectorCandidate& candidates, const vector2DMat& masks, const CancellationToken* token) {
+
+	CandidateSet set;
+	min_with_backtracking(parts, scores, Ix, Iy, Ik, rootv, rooti, scales, set, masks, token);
+	set.toCandidates(candidates);
+}
+
+/*! @brief Get the min of a dynamic program and backtrack the candidates in one pass
+ *
+ * The candidates are written to a flat CandidateSet. Each (scale, component) task
+ * backtracks into its own buffer, and the buffers are concatenated in task order
+ * once the parallel region completes, so no locking is required and the output
+ * order (scale, then component, then raster order of the root) does not depend
+ * on thread scheduling
+ *
+ * @param parts the parts tree, referenced by the root
+ * @param scores the probability densities (pdfs) of part locations (fine to coarse)
+ * @param rootv the root scores, across scale
+ * @param rooti the root indices, across scale
+ * @param scales the scales (used to calculate bounding box size)
+ * @param candidates the output set of candidates
+ * @param masks optional per-(scale, component) masks of valid root locations.
+ * Root scores outside the mask are set to -infinity before backtracking. An
+ * empty mask leaves that (scale, component) unconstrained, and scales with
+ * empty scores (pruned before convolution) are skipped entirely
+ * @param token polled between (scale, component) tasks. If cancelled, the
+ * remaining tasks are skipped and DetectionCancelled is thrown
+ */
 template<typename T>
-void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, vectorCandidate& candidates) {
+void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores, vector4DMat& Ix, vector4DMat& Iy, vector4DMat& Ik, vector2DMat& rootv, vector2DMat& rooti, const vectorf &scales, CandidateSet& candidates, const vector2DMat& masks, const CancellationToken* token) {
 
 	// initialize the outputs, preallocate vectors to make them thread safe
 	// TODO: better initialisation of Ix, Iy, Ik
@@ -115,7 +162,8 @@ void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores,
 	rootv.resize(nscales, vectorMat(ncomponents));
 	rooti.resize(nscales, vectorMat(ncomponents));
 
-    vector2DMat Ixnc, Iync, Iknc;
+	// one candidate buffer per task, merged in order after the parallel region
+	vector<CandidateSet> buffers(nscales*ncomponents);
 
 	// for each scale, and each component, update the scores through message passing
 	#ifdef _OPENMP
@@ -127,7 +175,12 @@ void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores,
 		const unsigned int n = floor((double)(nc/ncomponents));
 		const unsigned int c = nc % ncomponents;
 
+		// skip scales which were pruned before convolution
+		if (scores[n].empty() || scores[n][0].empty()) continue;
+		if (CancellationToken::isCancelled(token)) continue;
+
 		// allocate the inner loop variables
+		vector2DMat Ixnc, Iync, Iknc;
 		Ixnc.resize(parts.nparts(c));
 		Iync.resize(parts.nparts(c));
 		Iknc.resize(parts.nparts(c));
@@ -211,8 +264,19 @@ void DynamicProgram<T>::min_with_backtracking(Parts& parts, vector2DMat& scores,
 		}
 		Math::reduceMax<T>(weighted, rootv[n][c], rooti[n][c]);
 
-        backtrack<T>(n, c, thresh_, parts, rootv, rooti, scales, Ixnc, Iync, Iknc, candidates);
+		// discard root locations outside the search space
+		if (!masks.empty() && !masks[n][c].empty()) {
+			rootv[n][c].setTo(-numeric_limits<T>::infinity(), masks[n][c] == 0);
+		}
+
+		backtrack<T>(n, c, thresh_, nms_window_, parts, rootv, rooti, scales, Ixnc, Iync, Iknc, buffers[nc]);
+	}
+	if (CancellationToken::isCancelled(token)) {
+		rootv.clear();
+		rooti.clear();
+		CancellationToken::check(token);
 	}
+	CandidateSet::merge(buffers, candidates);
 }
 
 /*! @brief Get the min of a dynamic program
@@ -348,7 +412,10 @@ void DynamicProgram<T>::min(Parts& parts, vector2DMat& scores, vector4DMat& Ix,
 /*! @brief get the argmin of a dynamic program
  *
  * Get the minimum argument of a dynamic program by traversing down the tree of
- * a dynamic program, returning the locations of the best nodes
+ * a dynamic program, returning the locations of the best nodes. Each scale is
+ * backtracked into its own buffer and the buffers are concatenated in scale
+ * order, so the output order is independent of thread scheduling
+ *
  * @param parts the tree of parts, referenced by the root
  * @param rootv the root scores, across scale
  * @param rooti the root indices, across scale
@@ -363,67 +430,19 @@ void DynamicProgram<T>::argmin(Parts& parts, const vector2DMat& rootv, const vec
 
 	// for each scale, and each component, traverse back down the tree to retrieve the part positions
 	const unsigned int nscales = scales.size();
+	vector<CandidateSet> buffers(nscales);
 	#ifdef _OPENMP
 	#pragma omp parallel for
 	#endif
 	for (int n = 0; n < nscales; ++n) {
-		T scale = scales[n];
 		for (unsigned int c = 0; c < parts.ncomponents(); ++c) {
-
-			// get the scores and indices for this tree of parts
-			const vector2DMat& Iknc = Ik[n][c];
-			const vector2DMat& Ixnc = Ix[n][c];
-			const vector2DMat& Iync = Iy[n][c];
-			const unsigned int nparts = parts.nparts(c);
-
-			// threshold the root score
-			Mat over_thresh = rootv[n][c] > thresh_;
-			Mat rootmix     = rooti[n][c];
-			vectorPoint inds;
-			Math::find(over_thresh, inds);
-
-			for (unsigned int i = 0; i < inds.size(); ++i) {
-				Candidate candidate;
-				candidate.setComponent(c);
-				vectori     xv(nparts);
-				vectori     yv(nparts);
-				vectori     mv(nparts);
-				for (unsigned int p = 0; p < nparts; ++p) {
-					ComponentPart part = parts.component(c, p);
-					// calculate the child's points from the parent's points
-					unsigned int x, y, m;
-					if (part.isRoot()) {
-						x = xv[0] = inds[i].x;
-						y = yv[0] = inds[i].y;
-						m = mv[0] = rootmix.at<int>(inds[i]);
-					} else {
-						int idx = part.parent().self();
-						x = xv[idx];
-						y = yv[idx];
-						m = mv[idx];
-						xv[p] = Ixnc[p][m].at<int>(y,x);
-						yv[p] = Iync[p][m].at<int>(y,x);
-						mv[p] = Iknc[p][m].at<int>(y,x);
-					}
-
-					// calculate the bounding rectangle and add it to the Candidate
-					Point pone = Point(1,1);
-					Point xy1 = (Point(xv[p],yv[p])-pone)*scale;
-					Point xy2 = xy1 + Point(part.xsize(mv[p]), part.ysize(mv[p]))*scale - pone;
-					if (part.isRoot()) 
-					  candidate.addPart(Rect(xy1, xy2), rootv[n][c].at<T>(inds[i]));
-					else
-					  candidate.addPart(Rect(xy1, xy2), 0.0);
-				}
-				#ifdef _OPENMP
-				#pragma omp critical(addcandidate)
-				#endif
-				{
-					candidates.push_back(candidate);
-				}
-			}
+			backtrack<T>(n, c, thresh_, nms_window_, parts, rootv, rooti, scales, Ix[n][c], Iy[n][c], Ik[n][c], buffers[n]);
 		}
 	}
+
+	CandidateSet set;
+	CandidateSet::merge(buffers, set);
+	set.toCandidates(candidates);
 }
 
 
@@ -151,5 +151,6 @@ bool FileStorageModel::deserialize(const std::string& filename) {
 
 	// close the file store
 	fs.release();
+	source_ = filename;
 	return true;
 }
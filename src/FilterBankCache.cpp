@@ -0,0 +1,206 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    FilterBankCache.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <opencv2/core/core.hpp>
+#include <boost/filesystem.hpp>
+#include "FilterBankCache.hpp"
+using namespace cv;
+
+namespace {
+
+const char MAGIC[8] = { 'D', 'P', 'M', 'F', 'B', 'C', '\0', '\0' };
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME  = 1099511628211ULL;
+
+struct CacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t nfilters;
+	uint64_t key;
+};
+
+struct MatHeader {
+	int32_t rows;
+	int32_t cols;
+	int32_t type;
+	int32_t reserved;
+};
+
+//! fold a block of bytes into an FNV-1a hash
+uint64_t fnv1a(uint64_t hash, const void* data, size_t bytes) {
+	const uchar* p = static_cast<const uchar*>(data);
+	for (size_t n = 0; n < bytes; ++n) {
+		hash ^= p[n];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+template<typename T>
+uint64_t fnv1a(uint64_t hash, const T& value) {
+	return fnv1a(hash, &value, sizeof(T));
+}
+
+/*! @brief read a matrix of the given type, no larger than the rest of the file
+ *
+ * @param fs the cache file
+ * @param type the expected type of the matrix
+ * @param end the size of the file, in bytes
+ * @param m the matrix read
+ * @return true if a matrix of the expected type was read in full
+ */
+bool readMat(std::ifstream& fs, int type, std::streamoff end, Mat& m) {
+	MatHeader header;
+	if (!fs.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+	if (header.rows < 0 || header.cols < 0 || header.type != type) return false;
+	const std::streamoff bytes = (std::streamoff)header.rows * header.cols * CV_ELEM_SIZE(type);
+	if (bytes > end - (std::streamoff)fs.tellg()) return false;
+	m.create(header.rows, header.cols, type);
+	return (bool)fs.read(reinterpret_cast<char*>(m.data), bytes);
+}
+
+//! write a matrix and its header
+void writeMat(std::ofstream& fs, const Mat& mat) {
+	const Mat m = mat.isContinuous() ? mat : mat.clone();
+	MatHeader header;
+	header.rows = m.rows;
+	header.cols = m.cols;
+	header.type = m.type();
+	header.reserved = 0;
+	fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fs.write(reinterpret_cast<const char*>(m.data), m.total()*m.elemSize());
+}
+
+} // namespace
+
+uint64_t FilterBankCache::key(const std::string& source, int type, unsigned int flen) {
+
+	if (source.empty()) return 0;
+	boost::system::error_code error;
+	const boost::filesystem::path path = boost::filesystem::absolute(source);
+	const uint64_t size = boost::filesystem::file_size(path, error);
+	if (error) return 0;
+	const int64_t mtime = boost::filesystem::last_write_time(path, error);
+	if (error) return 0;
+
+	const std::string name = path.string();
+	uint64_t hash = FNV_OFFSET;
+	hash = fnv1a(hash, VERSION);
+	hash = fnv1a(hash, type);
+	hash = fnv1a(hash, flen);
+	hash = fnv1a(hash, name.data(), name.size());
+	hash = fnv1a(hash, size);
+	hash = fnv1a(hash, mtime);
+	return hash;
+}
+
+bool FilterBankCache::load(const std::string& filename, uint64_t key, int type, unsigned int flen,
+		vectorMat& filters, vector2DMat& planes) {
+
+	std::ifstream fs(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!fs) return false;
+	fs.seekg(0, std::ios::end);
+	const std::streamoff end = fs.tellg();
+	fs.seekg(0, std::ios::beg);
+
+	// check the header
+	CacheHeader header;
+	if (!fs.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+	if (header.version != VERSION || header.key != key) return false;
+
+	// read each filter and its planes, which must be of the engine type and
+	// tile the filter exactly
+	vectorMat resultfilters;
+	vector2DMat result;
+	for (unsigned int n = 0; n < header.nfilters; ++n) {
+		Mat filter;
+		if (!readMat(fs, type, end, filter)) return false;
+		uint32_t nplanes;
+		if (!fs.read(reinterpret_cast<char*>(&nplanes), sizeof(nplanes))) return false;
+		if (nplanes != flen) return false;
+		vectorMat filterplanes(nplanes);
+		for (unsigned int c = 0; c < nplanes; ++c) {
+			Mat& plane = filterplanes[c];
+			if (!readMat(fs, type, end, plane)) return false;
+			if (plane.rows != filter.rows || plane.cols * (int)flen != filter.cols) return false;
+		}
+		resultfilters.push_back(filter);
+		result.push_back(filterplanes);
+	}
+	filters.swap(resultfilters);
+	planes.swap(result);
+	return true;
+}
+
+bool FilterBankCache::save(const std::string& filename, uint64_t key, const vectorMat& filters, const vector2DMat& planes) {
+
+	CV_Assert(filters.size() == planes.size());
+
+	// write to a temporary file and move it into place, so that concurrent
+	// loaders never see a partially written cache
+	const std::string tmpname = filename + ".tmp";
+	{
+		std::ofstream fs(tmpname.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!fs) return false;
+
+		CacheHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version  = VERSION;
+		header.nfilters = filters.size();
+		header.key      = key;
+		fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (unsigned int n = 0; n < filters.size(); ++n) {
+			writeMat(fs, filters[n]);
+			const uint32_t nplanes = planes[n].size();
+			fs.write(reinterpret_cast<const char*>(&nplanes), sizeof(nplanes));
+			for (unsigned int c = 0; c < nplanes; ++c) writeMat(fs, planes[n][c]);
+		}
+		if (!fs.good()) {
+			fs.close();
+			std::remove(tmpname.c_str());
+			return false;
+		}
+	}
+	std::remove(filename.c_str());
+	return std::rename(tmpname.c_str(), filename.c_str()) == 0;
+}
@@ -84,6 +84,26 @@ void HOGFeatures<T>::boundaryOcclusionFeature(Mat& feature, const int flen, cons
 }
 
 
+/*! @brief the scales of the pyramid of an image
+ *
+ * Each scale is the number of image pixels spanned by a feature cell at
+ * that level of the pyramid. The first interval_ scales are spaced by
+ * sfactor_, and every subsequent scale is twice the scale one interval finer
+ *
+ * @param imsize the size of the input image
+ * @return the scales, fine to coarse
+ */
+template<typename T>
+vectorf HOGFeatures<T>::scales(const Size& imsize) const {
+
+	const int nscales = 1 + floor(log(min(imsize.height, imsize.width)/(5.0f*(float)binsize_))/log(sfactor_));
+	vectorf scales(max(nscales, 0));
+	for (int n = 0; n < nscales; ++n) {
+		scales[n] = (n < (int)interval_) ? pow(sfactor_,n)*binsize_ : 2 * scales[n-interval_];
+	}
+	return scales;
+}
+
 /*! @brief Calculate features at multiple scales
  *
  * Features are calculated first at native resolution,
@@ -98,56 +118,210 @@ void HOGFeatures<T>::boundaryOcclusionFeature(Mat& feature, const int flen, cons
  */
 template<typename T>
 void HOGFeatures<T>::pyramid(const Mat& im, vectorMat& pyrafeatures) {
+	pyramid(im, std::vector<bool>(), pyrafeatures);
+}
+
+/*! @brief Calculate features at a subset of scales
+ *
+ * Only the images which lead to a selected level are computed: each chain
+ * of power of two downsamplings stops at its last selected level, and
+ * features are only computed for the selected levels
+ *
+ * This function supports multithreading via OpenMP
+ *
+ * @param im the input image at native resolution
+ * @param levels the levels to compute (empty to compute all levels)
+ * @param pyrafeatures the pyramid of features, fine to coarse, each
+ * calculated via features(). Unselected levels are left empty
+ * @param token polled between levels. If cancelled, the remaining levels are
+ * skipped and DetectionCancelled is thrown
+ */
+template<typename T>
+void HOGFeatures<T>::pyramid(const Mat& im, const std::vector<bool>& levels, vectorMat& pyrafeatures, const CancellationToken* token) {
 
 	// calculate the scaling factor
-	Size_<float> imsize = im.size();
-	nscales_  = 1 + floor(log(min(imsize.height, imsize.width)/(5.0f*(float)binsize_))/log(sfactor_));
+	scales_   = scales(im.size());
+	nscales_  = scales_.size();
+	assert(levels.empty() || levels.size() == nscales_);
 
 	vectorMat pyraimages;
-	pyraimages.resize(nscales_);
+	images(im, levels, pyraimages);
 	pyrafeatures.clear();
 	pyrafeatures.resize(nscales_);
+
+	// perform the actual feature computation, in parallel if possible
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (int n = 0; n < nscales_; ++n) {
+		if (pyraimages[n].empty() || CancellationToken::isCancelled(token)) continue;
+		Mat feature;
+		features(pyraimages[n], feature);
+		//copyMakeBorder(feature, padded, 3, 3, 3*flen_, 3*flen_, BORDER_CONSTANT, 0);
+		//boundaryOcclusionFeature(padded, flen_, 3);
+		pyrafeatures[n] = feature;
+	}
+	if (CancellationToken::isCancelled(token)) {
+		pyrafeatures.clear();
+		CancellationToken::check(token);
+	}
+}
+
+/*! @brief update the features of the previous frame where the image changed
+ *
+ * A HOG cell depends only on the pixels of the surrounding blocks, so a
+ * changed pixel only invalidates the few cells (and their normalization
+ * blocks) around it. For each level of the pyramid, the changed regions are
+ * mapped to that level (padded by the spread of the resampling filters), the
+ * cells whose support they touch are recomputed from a block-aligned crop with
+ * a margin of valid context, and pasted over the previous features. The result
+ * is identical to recomputing the pyramid, at a cost proportional to the
+ * changed area. Image pyramid resampling is still done in full, as it is
+ * cheap relative to feature computation
+ *
+ * If the previous pyramid does not match the image (eg. the first frame, or a
+ * change of size), the whole pyramid is recomputed
+ *
+ * @param im the input image at native resolution
+ * @param changed a mask of the pixels which changed since the previous frame (nonzero where changed)
+ * @param pyrafeatures the pyramid of features of the previous frame, updated in place
+ */
+template<typename T>
+void HOGFeatures<T>::updatePyramid(const Mat& im, const Mat& changed, vectorMat& pyrafeatures) {
+
+	const vectorf scales = this->scales(im.size());
+	if (pyrafeatures.size() != scales.size() || changed.size() != im.size()) {
+		pyramid(im, pyrafeatures);
+		return;
+	}
+	scales_  = scales;
+	nscales_ = scales_.size();
+
+	// find the changed regions in image coordinates
+	Mat mask = changed != 0;
+	vector<vector<Point> > contours;
+	findContours(mask, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+	if (contours.empty()) return;
+	vector<Rect> regions(contours.size());
+	for (unsigned int n = 0; n < contours.size(); ++n) regions[n] = boundingRect(contours[n]);
+
+	vectorMat pyraimages;
+	images(im, std::vector<bool>(), pyraimages);
+
+	const int b = binsize_;
+	#ifdef _OPENMP
+	#pragma omp parallel for
+	#endif
+	for (int n = 0; n < nscales_; ++n) {
+		const Mat& level = pyraimages[n];
+		const Size blocks = Size(round((float)level.cols / (float)b), round((float)level.rows / (float)b));
+		const Size outsize = Size(max(blocks.width-2, 0), max(blocks.height-2, 0));
+		Mat& feature = pyrafeatures[n];
+		if (feature.rows != outsize.height || feature.cols != outsize.width*(int)flen_ || feature.depth() != DataType<T>::depth) {
+			features(level, feature);
+			continue;
+		}
+		const double fx = (double)im.cols / (double)level.cols;
+		const double fy = (double)im.rows / (double)level.rows;
+
+		// the ranges of output cells whose support contains a changed pixel.
+		// Output cell j is normalized over blocks j..j+2, whose histograms
+		// are interpolated from pixels within half a block
+		vector<Rect> dirty;
+		for (unsigned int r = 0; r < regions.size(); ++r) {
+			const double x0 = regions[r].x / fx - 4;
+			const double y0 = regions[r].y / fy - 4;
+			const double x1 = (regions[r].x + regions[r].width)  / fx + 4;
+			const double y1 = (regions[r].y + regions[r].height) / fy + 4;
+			Rect cells(Point(floor(x0 / b) - 4, floor(y0 / b) - 4), Point(ceil(x1 / b) + 1, ceil(y1 / b) + 1));
+			cells &= Rect(Point(0,0), outsize);
+			if (cells.area() > 0) dirty.push_back(cells);
+		}
+		for (bool merged = true; merged; ) {
+			merged = false;
+			for (unsigned int i = 0; i < dirty.size() && !merged; ++i) {
+				for (unsigned int j = i+1; j < dirty.size() && !merged; ++j) {
+					if ((dirty[i] & dirty[j]).area() == 0) continue;
+					dirty[i] |= dirty[j];
+					dirty.erase(dirty.begin() + j);
+					merged = true;
+				}
+			}
+		}
+
+		for (unsigned int r = 0; r < dirty.size(); ++r) {
+			// the block-aligned crop: one block of context before the dirty
+			// cells and three after, or up to the image boundary, where the
+			// crop is computed identically to the full image
+			const Rect& d = dirty[r];
+			const Point k0(max(d.x-1, 0), max(d.y-1, 0));
+			const Point k1(d.br().x + 3, d.br().y + 3);
+			const Point p0 = k0*b;
+			const Point p1(min(k1.x*b, level.cols), min(k1.y*b, level.rows));
+			Mat cropfeature;
+			features(level(Rect(p0, p1)), cropfeature);
+
+			// paste the recomputed cells over the previous features
+			const Rect src((d.x-k0.x)*flen_, d.y-k0.y, d.width*flen_, d.height);
+			const Rect dst(d.x*flen_, d.y, d.width*flen_, d.height);
+			cropfeature(src).copyTo(feature(dst));
+		}
+	}
+}
+
+/*! @brief compute the image pyramid
+ *
+ * @param im the input image at native resolution
+ * @param levels the levels to compute (empty to compute all levels). Each
+ * chain of power of two downsamplings stops at its last selected level
+ * @param pyraimages the output images, fine to coarse. Unselected levels are left empty
+ */
+template<typename T>
+void HOGFeatures<T>::images(const Mat& im, const std::vector<bool>& levels, vectorMat& pyraimages) const {
+
+	Size_<float> imsize = im.size();
+	pyraimages.clear();
 	pyraimages.resize(nscales_);
-	scales_.clear();
-	scales_.resize(nscales_);
 
 	// perform the non-power of two scaling
 	// TODO: is this the most intuitive way to represent scaling?
 	#ifdef _OPENMP
 	#pragma omp parallel for
 	#endif
-	for (int i = 0; i < interval_; ++i) {
+	for (int i = 0; i < (int)min(interval_, nscales_); ++i) {
+		// find the last level needed in this chain
+		int last = -1;
+		for (unsigned int j = i; j < nscales_; j+=interval_) {
+			if (levels.empty() || levels[j]) last = j;
+		}
+		if (last < 0) continue;
+
 		Mat scaled;
 		resize(im, scaled, imsize * (1.0f/pow(sfactor_,(int)i)));
-		pyraimages[i] = scaled;
-		scales_[i] = pow(sfactor_,(int)i)*binsize_;
+		if (levels.empty() || levels[i]) pyraimages[i] = scaled;
 		// perform subsequent power of two scaling
-		for (unsigned int j = i+interval_; j < nscales_; j+=interval_) {
+		for (int j = i+interval_; j <= last; j+=interval_) {
 			Mat scaled2;
 			pyrDown(scaled, scaled2);
-			pyraimages[j] = scaled2;
-			scales_[j] = 2 * scales_[j-interval_];
-			scaled2.copyTo(scaled);
+			if (levels.empty() || levels[j]) pyraimages[j] = scaled2;
+			scaled = scaled2;
 		}
 	}
+}
 
-	// perform the actual feature computation, in parallel if possible
-	#ifdef _OPENMP
-	#pragma omp parallel for
-	#endif
-	for (int n = 0; n < nscales_; ++n) {
-		Mat feature;
-		Mat padded;
-		switch (im.depth()) {
-			case CV_32F: features<float>(pyraimages[n], feature); break;
-			case CV_64F: features<double>(pyraimages[n], feature); break;
-			case CV_8U:  features<uint8_t>(pyraimages[n], feature); break;
-			case CV_16U: features<uint16_t>(pyraimages[n], feature); break;
-			default: CV_Error(CV_StsUnsupportedFormat, "Unsupported image type"); break;
-		}
-		//copyMakeBorder(feature, padded, 3, 3, 3*flen_, 3*flen_, BORDER_CONSTANT, 0);
-		//boundaryOcclusionFeature(padded, flen_, 3);
-		pyrafeatures[n] = feature;
+/*! @brief compute the HOG features for an image of any supported depth
+ *
+ * @param im the input image (CV_8U, CV_16U, CV_32F or CV_64F, 1 or 3 channels)
+ * @param feature the HOG features as a 2D matrix
+ */
+template<typename T>
+void HOGFeatures<T>::features(const Mat& im, Mat& feature) const {
+	switch (im.depth()) {
+		case CV_32F: features<float>(im, feature); break;
+		case CV_64F: features<double>(im, feature); break;
+		case CV_8U:  features<uint8_t>(im, feature); break;
+		case CV_16U: features<uint16_t>(im, feature); break;
+		default: CV_Error(CV_StsUnsupportedFormat, "Unsupported image type"); break;
 	}
 }
 
@@ -184,6 +184,7 @@ bool MatlabIOModel::deserialize(const std::string& filename) {
 		//biasi_.push_back(cvmatio.find<double>(bias[n], "i"));
 	}
 
+	source_ = filename;
 	return true;
 }
 
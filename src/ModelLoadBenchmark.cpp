@@ -0,0 +1,150 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    ModelLoadBenchmark.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <opencv2/core/core.hpp>
+#include <boost/filesystem.hpp>
+#include "BinaryModel.hpp"
+#include "FileStorageModel.hpp"
+#include "PartsBasedDetector.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief time deserializing a model and distributing it to a detector
+ *
+ * @param model the model to deserialize into
+ * @param filename the model file
+ * @param load the accumulated deserialization time, in seconds
+ * @param distribute the accumulated distribution time, in seconds
+ * @return true if the model was deserialized
+ */
+static bool timeLoad(Model& model, const string& filename, double& load, double& distribute) {
+	double t = (double)getTickCount();
+	if (!model.deserialize(filename)) return false;
+	load += ((double)getTickCount() - t)/getTickFrequency();
+	PartsBasedDetector<float> pbd;
+	t = (double)getTickCount();
+	pbd.distributeModel(model);
+	distribute += ((double)getTickCount() - t)/getTickFrequency();
+	return true;
+}
+
+/*! @brief time distributing a model through the filter bank cache
+ *
+ * @param model the deserialized model
+ * @param cache the cache file, removed first to time a miss
+ * @param hit whether to time a hit (the cache was written by a previous miss)
+ * @param distribute the accumulated distribution time, in seconds
+ * @return true if the cache was hit exactly when expected
+ */
+static bool timeCache(Model& model, const string& cache, bool hit, double& distribute) {
+	if (!hit) boost::filesystem::remove(cache);
+	PartsBasedDetector<float> pbd;
+	double t = (double)getTickCount();
+	const bool cached = pbd.distributeModel(model, 1.0f, cache);
+	distribute += ((double)getTickCount() - t)/getTickFrequency();
+	return cached == hit;
+}
+
+//! whether two models hold identical filter weights
+static bool sameFilters(Model& a, Model& b) {
+	if (a.filters().size() != b.filters().size()) return false;
+	for (unsigned int n = 0; n < a.filters().size(); ++n) {
+		const Mat& fa = a.filters()[n];
+		const Mat& fb = b.filters()[n];
+		if (fa.size() != fb.size() || fa.type() != fb.type()) return false;
+		if (norm(fa, fb, NORM_INF) != 0) return false;
+	}
+	return a.filterid() == b.filterid() && a.biasid() == b.biasid() &&
+		   a.defid() == b.defid() && a.parentid() == b.parentid();
+}
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc != 2 && argc != 3) {
+		printf("Usage: ModelLoadBenchmark model_file.{xml,yaml} [iterations]\n");
+		exit(-1);
+	}
+	const int N = (argc == 3) ? atoi(argv[2]) : 10;
+
+	// convert the model to the binary format
+	FileStorageModel xml;
+	if (!xml.deserialize(argv[1])) {
+		printf("Error deserializing file\n");
+		exit(-3);
+	}
+	const string binfile = (boost::filesystem::temp_directory_path() /
+			boost::filesystem::unique_path("%%%%-%%%%-%%%%.dpm")).string();
+	if (!BinaryModel(xml).serialize(binfile)) {
+		printf("Error serializing binary model to %s\n", binfile.c_str());
+		exit(-4);
+	}
+	BinaryModel bin;
+	const bool ok = bin.deserialize(binfile) && sameFilters(xml, bin);
+
+	// time repeated loads of each, and distribution through the filter bank
+	// cache on a miss (which builds it) and a hit
+	const string cachefile = binfile + ".f32.fbc";
+	double tload[2] = {0, 0};
+	double tdist[2] = {0, 0};
+	double tcache[2] = {0, 0};
+	bool cacheok = true;
+	for (int n = 0; n < N; ++n) {
+		FileStorageModel xmln;
+		BinaryModel binn;
+		timeLoad(xmln, argv[1], tload[0], tdist[0]);
+		timeLoad(binn, binfile, tload[1], tdist[1]);
+		BinaryModel missn, hitn;
+		cacheok = cacheok && missn.deserialize(binfile) && timeCache(missn, cachefile, false, tcache[0]);
+		cacheok = cacheok && hitn.deserialize(binfile) && timeCache(hitn, cachefile, true, tcache[1]);
+		cacheok = cacheok && sameFilters(missn, hitn);
+	}
+	boost::filesystem::remove(cachefile);
+	boost::filesystem::remove(binfile);
+
+	printf("Model load (%d iterations, %s):\n", N, ok ? "round trip ok" : "round trip MISMATCH");
+	printf("  XML/YAML: deserialize %8.3f ms  distribute %8.3f ms\n", tload[0]*1e3/N, tdist[0]*1e3/N);
+	printf("  binary:   deserialize %8.3f ms  distribute %8.3f ms\n", tload[1]*1e3/N, tdist[1]*1e3/N);
+	printf("  speedup:  %.1fx\n", tload[0]/tload[1]);
+	printf("Filter bank cache (%s):\n", cacheok ? "ok" : "MISMATCH");
+	printf("  miss:     distribute %8.3f ms\n", tcache[0]*1e3/N);
+	printf("  hit:      distribute %8.3f ms  (%.1fx vs. uncached)\n", tcache[1]*1e3/N, tdist[1]/tcache[1]);
+	return ok && cacheok ? 0 : 1;
+}
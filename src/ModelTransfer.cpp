@@ -37,38 +37,68 @@
  */
 
 #include <iostream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <opencv2/core/core.hpp>
 #include "MatlabIOModel.hpp"
 #include "FileStorageModel.hpp"
+#include "BinaryModel.hpp"
 using namespace std;
 
+/*! @brief allocate a model of the type implied by the file extension
+ *
+ * .mat files are Matlab models, .xml and .yaml files are OpenCV FileStorage
+ * models and .dpm files are memory-mappable binary models
+ */
+static Model* modelForFile(const string& filename) {
+	string ext = boost::filesystem::path(filename).extension().string();
+	if (ext.compare(".mat") == 0) return new MatlabIOModel;
+	if (ext.compare(".xml") == 0 || ext.compare(".yaml") == 0) return new FileStorageModel;
+	if (ext.compare(".dpm") == 0) return new BinaryModel;
+	return NULL;
+}
+
 int main(int argc, char** argv) {
 
 	// check for usage
 	if (argc != 3) {
-		cerr << "Usage: ModelTransfer /path/to/mat/file /path/to/xml/file" << endl;
+		cerr << "Usage: ModelTransfer /path/to/input/{mat,xml,yaml,dpm}/file /path/to/output/{xml,yaml,dpm}/file" << endl;
 		exit(-1);
 	}
 	// allocate two models
-	Model* matlab = new MatlabIOModel;
-	Model* cv     = new FileStorageModel;
+	Model* in  = modelForFile(argv[1]);
+	Model* out = modelForFile(argv[2]);
+	if (!in || !out || dynamic_cast<MatlabIOModel*>(out)) {
+		cerr << "Unsupported model format" << endl;
+		exit(-2);
+	}
 
-	// deserialize the Matlab model, cast sideways and serialize
-	// an OpenCV FileStorage model
+	// deserialize the input model, cast sideways and serialize
+	// the output model
 	cout << "-------------------------------" << endl;
 	cout << "        Model Transfer         " << endl;
 	cout << "-------------------------------" << endl;
 	cout << "" << endl;
-	cout << "deserializing Matlab (.mat) model..." << endl;
-	matlab->deserialize(argv[1]);
+	cout << "deserializing " << argv[1] << "..." << endl;
+	double t = (double)cv::getTickCount();
+	if (!in->deserialize(argv[1])) {
+		cerr << "Error deserializing file" << endl;
+		exit(-3);
+	}
+	t = ((double)cv::getTickCount() - t) / cv::getTickFrequency();
+	cout << "load time: " << t*1000.0 << " ms" << endl;
 	cout << "converting..." << endl;
-	(*cv) = (*matlab);
-	cout << "serializing to OpenCV (.xml) model..." << endl;
-	cv->serialize(argv[2]);
+	(*out) = (*in);
+	cout << "serializing to " << argv[2] << "..." << endl;
+	if (!out->serialize(argv[2])) {
+		cerr << "Error serializing file" << endl;
+		exit(-4);
+	}
 	cout << "Conversion complete" << endl;
 	cout << "-------------------------------" << endl;
 
 	// cleanup
-	delete matlab;
-	delete cv;
+	delete in;
+	delete out;
 	return 0;
 }
@@ -0,0 +1,107 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    NmsCheck.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdint.h>
+#include <opencv2/core/core.hpp>
+#include "nms.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief whether the floating point fast path and the generic path agree
+ *
+ * the scores are distinct negative integers, so the same values can be
+ * held exactly in a CV_32S matrix (which takes the generic path) and a
+ * CV_32F matrix (which takes the fast path)
+ *
+ * @param scores the CV_32S scores
+ * @param sz the size of the window
+ * @param mask the mask of elements to consider (empty for none)
+ * @return the number of elements on which the two masks of maxima differ
+ */
+static int disagreement(const Mat& scores, int sz, const Mat& mask) {
+	Mat fscores, generic, fast, differ;
+	scores.convertTo(fscores, CV_32F);
+	nonMaximaSuppression(scores, sz, generic, mask);
+	nonMaximaSuppression(fscores, sz, fast, mask);
+	compare(generic, fast, differ, CMP_NE);
+	return countNonZero(differ);
+}
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc > 2) {
+		printf("Usage: NmsCheck [ntrials]\n");
+		exit(-1);
+	}
+	const int N = (argc == 2) ? atoi(argv[1]) : 20;
+
+	RNG rng(0xdeadbeef);
+	const int sizes[] = { 1, 2, 4, 8 };
+	int failures = 0;
+	for (int n = 0; n < N; ++n) {
+		const int sz = sizes[n % 4];
+		// distinct negative scores in a scrambled order
+		Mat scores(rng.uniform(20, 120), rng.uniform(20, 120), CV_32S);
+		for (int i = 0; i < scores.rows; ++i) {
+			for (int j = 0; j < scores.cols; ++j) {
+				scores.at<int>(i,j) = -(i*scores.cols + j) * 7919 % 1000003 - 1;
+			}
+		}
+
+		// a random mask with a fully masked block, and a sparse mask whose
+		// unmasked elements have fully masked neighbourhoods
+		Mat dense(scores.size(), CV_8U), sparse = Mat::zeros(scores.size(), CV_8U);
+		rng.fill(dense, RNG::UNIFORM, 0, 2);
+		dense = dense != 0;
+		dense(Rect(0, 0, min(2*sz+2, scores.cols), min(2*sz+2, scores.rows))).setTo(0);
+		for (int i = 0; i < scores.rows; i += 2*sz+2) {
+			for (int j = 0; j < scores.cols; j += 2*sz+2) sparse.at<uint8_t>(i,j) = 255;
+		}
+
+		const int d[3] = { disagreement(scores, sz, Mat()), disagreement(scores, sz, dense), disagreement(scores, sz, sparse) };
+		if (d[0] || d[1] || d[2]) {
+			printf("Trial %d (%dx%d, window %d): %d/%d/%d elements differ (unmasked/dense/sparse)\n",
+					n, scores.cols, scores.rows, sz, d[0], d[1], d[2]);
+			failures++;
+		}
+	}
+	printf("Non-maxima suppression of negative scores (%d trials): %s\n", N, failures ? "MISMATCH" : "ok");
+	return failures ? 1 : 0;
+}
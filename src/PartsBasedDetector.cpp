@@ -38,9 +38,12 @@
 
 #include "PartsBasedDetector.hpp"
 #include "nms.hpp"
-#include "HOGFeatures.hpp"
-#include "SpatialConvolutionEngine.hpp"
 #include <cstdio>
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 using namespace cv;
 using namespace std;
 
@@ -63,46 +66,250 @@ void PartsBasedDetector<T>::detect(const cv::Mat& im, vectorCandidate& candidate
  * The object, number of scales, detection confidence, etc are all defined through the Model.
  *
  * @param im the input color or grayscale image
- * @param depth the image depth image, used for depth consistency and search space pruning
+ * @param depth the image depth image, used for depth consistency and search space pruning.
+ * If a depth prior has been set (see setDepthPrior()), root locations whose implied
+ * metric size is implausible are never reported, and scales with no plausible locations are
+ * not convolved at all. With setDepthScaleSelection(), pyramid levels inconsistent
+ * with the depth histogram of the frame are not computed in the first place
  * @param candidates the output vector of detection candidates above the threshold
  */
 template<typename T>
 void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, vectorCandidate& candidates) {
+	detect(im, depth, DetectOptions(), candidates);
+}
 
-	// calculate a feature pyramid for the new image
-	vectorMat pyramid;
-	features_->pyramid(im, pyramid);
-
-	// convolve the feature pyramid with the Part experts
-	// to get probability density for each Part
-	//double t = (double)getTickCount();
-	vector2DMat pdf;
-	convolution_engine_->pdf(pyramid, pdf);
-	//printf("Convolution time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
-
-	// use dynamic programming to predict the best detection candidates from the part responses
-	vector4DMat Ix, Iy, Ik;
-	vector2DMat rootv, rooti;
-	//t = (double)getTickCount();
-	// dp_.min(parts_, pdf, Ix, Iy, Ik, rootv, rooti);
-	dp_.min_with_backtracking(parts_, pdf, Ix, Iy, Ik, rootv, rooti, features_->scales(), candidates);
-	//printf("DP min time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
-
-	// walk back down the tree to find the part locations
-	//t = (double)getTickCount();
-	// dp_.argmin(parts_, rootv, rooti, features_->scales(), Ix, Iy, Ik, candidates);
-	//printf("DP argmin time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
-
-	// suppress non-maximal candidates
-	//t = (double)getTickCount();
-	Candidate::nonMaximaSuppression(im, candidates, 0.4);
+/*! @brief search an image for potential object candidates, with options
+ *
+ * @param im the input color or grayscale image
+ * @param depth the image depth image (may be empty)
+ * @param options restrictions on the search. Pyramid levels at which no component
+ * falls within [options.minObjectSize, options.maxObjectSize] are never computed,
+ * convolved or searched. If options.cancel is set, it is polled between pyramid
+ * levels, convolution tasks and dynamic program tasks. If options.inputScale is set,
+ * im is a reduced image (see ReducedImageReader) and the candidates are returned
+ * in original image coordinates. If options.stats is set, it receives the cost
+ * of each stage (also available from stats() until the next detection)
+ * @param candidates the output vector of detection candidates above the threshold
+ * @throws DetectionCancelled if options.cancel is cancelled before detection completes
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const Mat& depth, const DetectOptions& options, vectorCandidate& candidates) {
+
+	// detect and suppress non-maximal candidates
+	context_->detect(im, depth, options, candidates);
 	//ssp_.nonMaxSuppression(rootv, features_->scales());
-	//printf("non-maxima suppression time: %f\n", ((double)getTickCount() - t)/getTickFrequency());
 
 //	if (!depth.empty()) {
 		//ssp_.filterCandidatesByDepth(parts_, candidates, depth, 0.03);
 //	}
+}
+
+/*! @brief search regions of interest of an image for potential object candidates
+ *
+ * Each region is padded so that the features and part responses of objects
+ * whose root lies in the region are computed with their full context, and
+ * overlapping padded regions are merged so that shared area is only processed
+ * once. The detection pipeline is then run on each merged region, and the
+ * candidates whose root intersects a region of interest are mapped back to
+ * image coordinates and suppressed jointly. The cost therefore scales with the
+ * area of interest rather than the frame size. Objects larger than their
+ * padded region cannot be detected. stats() reports the total cost over all
+ * regions
+ *
+ * @param im the input color or grayscale image
+ * @param rois the regions of interest, in image coordinates
+ * @param candidates the output vector of detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detect(const Mat& im, const vector<Rect>& rois, vectorCandidate& candidates) {
+
+	// pad by the largest filter extent, in cells, plus the cells lost at the
+	// feature boundary. Filters are stored flattened to rows x (cols*flen)
+	int fmax = 0;
+	const int flen = model_->flen();
+	const vectorMat& filters = model_->parts().filters();
+	for (unsigned int n = 0; n < filters.size(); ++n) fmax = max(fmax, max(filters[n].rows, filters[n].cols / flen));
+	const int pad = (fmax + 3) * model_->binsize();
+	const Rect bounds = Rect(Point(0,0), im.size());
+
+	// pad the regions and merge those which overlap
+	vector<Rect> regions;
+	for (unsigned int n = 0; n < rois.size(); ++n) {
+		Rect r = Rect(rois[n].x - pad, rois[n].y - pad, rois[n].width + 2*pad, rois[n].height + 2*pad) & bounds;
+		if (r.area() > 0) regions.push_back(r);
+	}
+	for (bool merged = true; merged; ) {
+		merged = false;
+		for (unsigned int i = 0; i < regions.size() && !merged; ++i) {
+			for (unsigned int j = i+1; j < regions.size() && !merged; ++j) {
+				if ((regions[i] & regions[j]).area() == 0) continue;
+				regions[i] |= regions[j];
+				regions.erase(regions.begin() + j);
+				merged = true;
+			}
+		}
+	}
 
+	// detect within each region, and map back to image coordinates. The
+	// padding also finds objects outside the regions of interest, so only
+	// candidates whose root intersects one of the regions are kept
+	DetectStats stats;
+	candidates.clear();
+	for (unsigned int n = 0; n < regions.size(); ++n) {
+		vectorCandidate region_candidates;
+		detectRaw(im(regions[n]), Mat(), DetectOptions(), region_candidates);
+		stats += context_->stats();
+		for (unsigned int i = 0; i < region_candidates.size(); ++i) {
+			region_candidates[i].translate(regions[n].tl());
+			const Rect root = region_candidates[i].parts()[0];
+			bool inside = false;
+			for (unsigned int r = 0; r < rois.size() && !inside; ++r) inside = (root & rois[r]).area() > 0;
+			if (inside) candidates.push_back(region_candidates[i]);
+		}
+	}
+
+	// suppress non-maximal candidates across all regions
+	const int64 t = getTickCount();
+	Candidate::sort(candidates);
+	Candidate::nonMaximaSuppression(im, candidates, 0.4);
+	stats.nmsTime = (getTickCount() - t) / getTickFrequency();
+	stats.candidates = candidates.size();
+	context_->setStats(stats);
+}
+
+/*! @brief search an image for potential object candidates within a deadline
+ *
+ * The pyramid is processed one octave at a time, from coarse to fine: the
+ * coarse levels are the cheapest and catch the largest objects. Each octave
+ * runs under a DeadlineToken, so an octave still in progress at the deadline
+ * is cancelled (overrunning by at most one pipeline task) and discarded.
+ * Before each octave after the first, its cost is also predicted from the
+ * cost of the previous octave (scaled by the relative feature area), and
+ * detection stops early if the octave would not finish in time. The
+ * candidates found in the octaves that finished are suppressed and returned,
+ * and stats() reports their total cost
+ *
+ * @param im the input color or grayscale image
+ * @param deadline the time by which to return, in cv::getTickCount() ticks
+ * @param candidates the output vector of detection candidates above the threshold
+ * @param covered the output flags of the pyramid levels which were searched,
+ * indexed as IFeatures::scales(im.size())
+ * @return true if every level was searched
+ */
+template<typename T>
+bool PartsBasedDetector<T>::detect(const Mat& im, int64 deadline, vectorCandidate& candidates, vector<bool>& covered) {
+
+	// group the levels by octave
+	const vectorf scales = context_->scales(im.size());
+	const int N = scales.size();
+	vectori octave(N, 0);
+	int noctaves = 0;
+	for (int n = 0; n < N; ++n) {
+		octave[n] = floor(log(scales[n] / scales[0]) / log(2.0) + 1e-6);
+		noctaves = max(noctaves, octave[n]+1);
+	}
+
+	candidates.clear();
+	covered.assign(N, false);
+	DeadlineToken token(deadline);
+	DetectStats stats;
+	double last_cost = 0, last_area = 0;
+	for (int o = noctaves-1; o >= 0; --o) {
+		DetectOptions options;
+		options.cancel = &token;
+		options.levels.assign(N, false);
+		double area = 0;
+		for (int n = 0; n < N; ++n) {
+			if (octave[n] != o) continue;
+			options.levels[n] = true;
+			area += 1.0 / (scales[n] * scales[n]);
+		}
+
+		// stop if the octave is predicted to overrun the deadline
+		const int64 start = getTickCount();
+		if (start >= deadline) break;
+		if (last_area > 0 && start + last_cost * area / last_area > deadline) break;
+
+		vectorCandidate octave_candidates;
+		try {
+			detectRaw(im, Mat(), options, octave_candidates);
+		} catch (const DetectionCancelled&) {
+			break;
+		}
+		stats += context_->stats();
+		candidates.insert(candidates.end(), octave_candidates.begin(), octave_candidates.end());
+		for (int n = 0; n < N; ++n) if (options.levels[n]) covered[n] = true;
+		last_cost = getTickCount() - start;
+		last_area = area;
+	}
+
+	// suppress non-maximal candidates across all covered levels
+	const int64 t = getTickCount();
+	Candidate::sort(candidates);
+	Candidate::nonMaximaSuppression(im, candidates, 0.4);
+	stats.nmsTime = (getTickCount() - t) / getTickFrequency();
+	stats.candidates = candidates.size();
+	context_->setStats(stats);
+	return std::find(covered.begin(), covered.end(), false) == covered.end();
+}
+
+/*! @brief search a batch of images for potential object candidates
+ *
+ * When there are at least as many images as threads, the images are
+ * distributed across the threads, each with its own DetectionContext over
+ * the shared model, and the (nested) parallelism within each image is
+ * left to the OpenMP runtime. Smaller batches are processed one image at a
+ * time with all threads working within each image
+ *
+ * @param images the input color or grayscale images
+ * @param candidates the output detection candidates, one vector per image
+ */
+template<typename T>
+void PartsBasedDetector<T>::detectBatch(const vectorMat& images, vector<vectorCandidate>& candidates) {
+
+	const int N = images.size();
+	candidates.clear();
+	candidates.resize(N);
+#ifdef _OPENMP
+	const int nthreads = omp_get_max_threads();
+#else
+	const int nthreads = 1;
+#endif
+	if (N < nthreads || nthreads == 1) {
+		for (int n = 0; n < N; ++n) detect(images[n], candidates[n]);
+		return;
+	}
+
+	// one copy of the mutable pipeline state per thread
+	vector<boost::shared_ptr<DetectionContext<T> > > contexts(nthreads);
+	for (int t = 0; t < nthreads; ++t) {
+		contexts[t].reset(context_->clone());
+	}
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic, 1)
+#endif
+	for (int n = 0; n < N; ++n) {
+#ifdef _OPENMP
+		const int t = omp_get_thread_num();
+#else
+		const int t = 0;
+#endif
+		contexts[t]->detectRaw(images[n], Mat(), DetectOptions(), candidates[n]);
+		Candidate::nonMaximaSuppression(images[n], candidates[n], 0.4);
+	}
+}
+
+/*! @brief run the detection pipeline up to (but not including) non-maxima suppression
+ *
+ * @param im the input color or grayscale image
+ * @param depth the depth image (may be empty)
+ * @param options restrictions on the search
+ * @param candidates the output vector of raw detection candidates above the threshold
+ */
+template<typename T>
+void PartsBasedDetector<T>::detectRaw(const Mat& im, const Mat& depth, const DetectOptions& options, vectorCandidate& candidates) {
+	context_->detectRaw(im, depth, options, candidates);
 }
 
 /*! @brief Distribute the model parameters to the PartsBasedDetector classes
@@ -123,32 +330,44 @@ void PartsBasedDetector<T>::distributeModel(Model& model) {
 template<typename T>
 void PartsBasedDetector<T>::distributeModel(Model& model, float threshold) {
 
-	// the name of the Part detector
-	name_ = model.name();
-
-	// initialize the Feature engine
-	features_.reset(new HOGFeatures<T>(model.binsize(), model.nscales(), model.flen(), model.norient()));
-
-	//initialise the convolution engine
-	convolution_engine_.reset(new SpatialConvolutionEngine(DataType<T>::type, model.flen()));
-
-	// make sure the filters are of the correct precision for the Feature engine
-	const unsigned int nfilters = model.filters().size();
-	for (unsigned int n = 0; n < nfilters; ++n) {
-		model.filters()[n].convertTo(model.filters()[n], DataType<T>::type);
-	}
-	convolution_engine_->setFilters(model.filters());
+	distributeModel(model, threshold, std::string());
+}
 
-	// initialize the tree of Parts
-	parts_ = Parts(model.filters(), model.filtersi(), model.def(), model.defi(), model.bias(), model.biasi(),
-			model.anchors(), model.biasid(), model.filterid(), model.defid(), model.parentid());
+/*! @brief Distribute the model parameters to the PartsBasedDetector classes
+ *
+ * The engine-ready filter bank (filters converted to the detector precision
+ * and split into planes) is read from the given sidecar cache if it was
+ * built from the same model file, and otherwise computed and written back to it,
+ * so repeated loads of a model skip the conversion and splitting
+ *
+ * @param model the monolithic model containing the deserialization of all model parameters
+ * @param threshold the multiplication value to adjust the matching threshold value
+ * @param cache the filter bank cache file (empty for no caching)
+ * @return true if the filter bank was read from the cache
+ */
+template<typename T>
+bool PartsBasedDetector<T>::distributeModel(Model& model, float threshold, const std::string& cache) {
 
-	// initialize the dynamic program
-	dp_ = DynamicProgram<T>(model.thresh()*threshold);
+	// the name of the Part detector
+	name_ = model.name();
 
+	// compile the immutable model, and the detector's own context on it
+	model_.reset(new CompiledModel<T>(model, threshold, cache));
+	context_.reset(new DetectionContext<T>(model_));
+	return model_->cached();
 }
 
-
+/*! @brief the approximate memory held by the distributed model
+ *
+ * the footprint of the shared model, excluding the filter engines held by
+ * each DetectionContext
+ *
+ * @return the footprint, in bytes
+ */
+template<typename T>
+size_t PartsBasedDetector<T>::footprint(void) const {
+	return model_ ? model_->footprint() + sizeof(*this) : sizeof(*this);
+}
 
 // declare all specializations of the template
 template class PartsBasedDetector<float>;
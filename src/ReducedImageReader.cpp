@@ -0,0 +1,206 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    ReducedImageReader.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include "ReducedImageReader.hpp"
+#ifdef HAVE_JPEG
+#include <csetjmp>
+extern "C" {
+#include <jpeglib.h>
+}
+#endif
+using namespace cv;
+using namespace std;
+
+#ifdef HAVE_JPEG
+namespace {
+
+//! whether a file starts with the JPEG start of image marker
+bool isJpeg(FILE* file) {
+	unsigned char soi[2] = { 0, 0 };
+	const bool jpeg = fread(soi, 1, 2, file) == 2 && soi[0] == 0xFF && soi[1] == 0xD8;
+	rewind(file);
+	return jpeg;
+}
+
+/*! the default libjpeg error handler exits the process, so errors
+ * jump back to the caller instead */
+struct JpegError {
+	jpeg_error_mgr mgr;
+	jmp_buf jump;
+};
+
+void onJpegError(j_common_ptr cinfo) {
+	longjmp(reinterpret_cast<JpegError*>(cinfo->err)->jump, 1);
+}
+
+/*! the state of one decode. Only plain C structs, so that an error
+ * jumping out of a helper never skips a destructor */
+struct JpegDecoder {
+	jpeg_decompress_struct cinfo;
+	JpegError error;
+};
+
+/*! @brief read the header and start decompression, scaled in the DCT domain
+ *
+ * @param jpeg the decoder, destroyed unless decompression was started
+ * @param file the open JPEG file
+ * @param denom the reduction (0 to read the header only)
+ * @param size the full resolution size of the image
+ * @return true if the header was read and, unless denom is 0, decompression started
+ */
+bool startJpeg(JpegDecoder& jpeg, FILE* file, int denom, Size& size) {
+
+	jpeg.cinfo.err = jpeg_std_error(&jpeg.error.mgr);
+	jpeg.error.mgr.error_exit = onJpegError;
+	if (setjmp(jpeg.error.jump)) {
+		jpeg_destroy_decompress(&jpeg.cinfo);
+		return false;
+	}
+
+	jpeg_create_decompress(&jpeg.cinfo);
+	jpeg_stdio_src(&jpeg.cinfo, file);
+	jpeg_read_header(&jpeg.cinfo, TRUE);
+	size.width  = jpeg.cinfo.image_width;
+	size.height = jpeg.cinfo.image_height;
+	const bool gray = jpeg.cinfo.jpeg_color_space == JCS_GRAYSCALE;
+	if (denom == 0 || (!gray && jpeg.cinfo.num_components != 3)) {
+		// CMYK and friends are left to the full decoder
+		jpeg_destroy_decompress(&jpeg.cinfo);
+		return denom == 0;
+	}
+
+	jpeg.cinfo.scale_num = 1;
+	jpeg.cinfo.scale_denom = denom;
+	jpeg.cinfo.out_color_space = gray ? JCS_GRAYSCALE : JCS_RGB;
+	jpeg_start_decompress(&jpeg.cinfo);
+	return true;
+}
+
+/*! @brief decompress the scanlines of a started decoder, then destroy it
+ *
+ * @param jpeg the decoder, after startJpeg()
+ * @param data the output image, output_height rows of output_width*output_components bytes
+ * @param step the stride of the output image in bytes
+ * @return true if every scanline was decoded
+ */
+bool readJpeg(JpegDecoder& jpeg, unsigned char* data, size_t step) {
+
+	if (setjmp(jpeg.error.jump)) {
+		jpeg_destroy_decompress(&jpeg.cinfo);
+		return false;
+	}
+	while (jpeg.cinfo.output_scanline < jpeg.cinfo.output_height) {
+		JSAMPROW row = data + jpeg.cinfo.output_scanline*step;
+		jpeg_read_scanlines(&jpeg.cinfo, &row, 1);
+	}
+	jpeg_finish_decompress(&jpeg.cinfo);
+	jpeg_destroy_decompress(&jpeg.cinfo);
+	return true;
+}
+
+/*! @brief decode a JPEG file, scaled in the DCT domain
+ *
+ * libjpeg reports errors by longjmp, so it is only called from startJpeg()
+ * and readJpeg(). The output is allocated here, between the two
+ *
+ * @param file the open JPEG file
+ * @param denom the reduction (0 to read the header only)
+ * @param size the full resolution size of the image
+ * @param im the decoded BGR image (untouched if denom is 0)
+ * @return true if the file was decoded
+ */
+bool decodeJpeg(FILE* file, int denom, Size& size, Mat& im) {
+
+	JpegDecoder jpeg;
+	if (!startJpeg(jpeg, file, denom, size)) return false;
+	if (denom == 0) return true;
+
+	const bool gray = jpeg.cinfo.out_color_space == JCS_GRAYSCALE;
+	Mat decoded;
+	try {
+		decoded.create(jpeg.cinfo.output_height, jpeg.cinfo.output_width, gray ? CV_8UC1 : CV_8UC3);
+	} catch (...) {
+		jpeg_destroy_decompress(&jpeg.cinfo);
+		throw;
+	}
+	if (!readJpeg(jpeg, decoded.data, decoded.step)) return false;
+
+	cvtColor(decoded, im, gray ? CV_GRAY2BGR : CV_RGB2BGR);
+	return true;
+}
+
+} // namespace
+#endif
+
+bool ReducedImageReader::size(const string& filename, Size& size) {
+
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (!file) return false;
+	bool read = false;
+#ifdef HAVE_JPEG
+	Mat unused;
+	if (isJpeg(file)) read = decodeJpeg(file, 0, size, unused);
+#endif
+	fclose(file);
+	return read;
+}
+
+Mat ReducedImageReader::read(const string& filename, int denom) {
+
+	CV_Assert(denom == 1 || denom == 2 || denom == 4 || denom == 8);
+	Mat im;
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (!file) return im;
+	bool decoded = false;
+#ifdef HAVE_JPEG
+	Size size;
+	if (isJpeg(file)) decoded = decodeJpeg(file, denom, size, im);
+#endif
+	fclose(file);
+	if (decoded) return im;
+
+	// decode at full resolution and downsample to the same size the DCT
+	// scaling would have produced
+	im = imread(filename);
+	if (im.empty() || denom == 1) return im;
+	Mat reduced;
+	resize(im, reduced, Size((im.cols + denom - 1) / denom, (im.rows + denom - 1) / denom), 0, 0, INTER_AREA);
+	return reduced;
+}
@@ -0,0 +1,197 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    ReducedReadCheck.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include "BinaryModel.hpp"
+#include "Candidate.hpp"
+#include "DetectOptions.hpp"
+#include "FileStorageModel.hpp"
+#include "PartsBasedDetector.hpp"
+#include "ReducedImageReader.hpp"
+using namespace cv;
+using namespace std;
+
+//! the fraction of their union two boxes share
+static double intersectionOverUnion(const Rect& a, const Rect& b) {
+	const double inter = (a & b).area();
+	const double uni = a.area() + b.area() - inter;
+	return (uni > 0) ? inter / uni : 0;
+}
+
+//! detection agreement accumulated over the image set
+struct Agreement {
+	Agreement() : images(0), reference(0), test(0), matched(0), identical(0),
+		score_diff(0), max_score_diff(0), iou(0) {}
+	int images;             //!< images compared
+	int reference;          //!< candidates from the full resolution image
+	int test;               //!< candidates from the reduced image
+	int matched;            //!< reference candidates with a reduced match
+	int identical;          //!< images on which every candidate matched
+	double score_diff;      //!< summed absolute score difference of matches
+	double max_score_diff;  //!< largest absolute score difference of a match
+	double iou;             //!< summed intersection over union of matches
+};
+
+/*! @brief match the candidates of the reduced image to those of the full resolution image
+ *
+ * Candidates are matched greedily, best first, to the unmatched candidate of
+ * the other image whose bounding box overlaps most, if the intersection
+ * over union is at least min_iou
+ *
+ * @param reference the full resolution candidates, sorted
+ * @param test the reduced candidates, sorted
+ * @param min_iou the overlap required for a match
+ * @param agreement the accumulated agreement
+ */
+static void match(const vectorCandidate& reference, const vectorCandidate& test, double min_iou, Agreement& agreement) {
+	vector<bool> used(test.size(), false);
+	int matched = 0;
+	for (unsigned int r = 0; r < reference.size(); ++r) {
+		const Rect box = reference[r].boundingBox();
+		int best = -1;
+		double best_iou = min_iou;
+		for (unsigned int t = 0; t < test.size(); ++t) {
+			if (used[t]) continue;
+			const double iou = intersectionOverUnion(box, test[t].boundingBox());
+			if (iou >= best_iou) { best = t; best_iou = iou; }
+		}
+		if (best < 0) continue;
+		used[best] = true;
+		const double diff = fabs(reference[r].score() - test[best].score());
+		agreement.score_diff += diff;
+		agreement.max_score_diff = max(agreement.max_score_diff, diff);
+		agreement.iou += best_iou;
+		matched++;
+	}
+	agreement.images++;
+	agreement.reference += reference.size();
+	agreement.test += test.size();
+	agreement.matched += matched;
+	if (matched == (int)reference.size() && matched == (int)test.size()) agreement.identical++;
+}
+
+//! the images named on the command line, expanding directories
+static vector<string> imageFiles(int argc, char** argv) {
+	vector<string> files;
+	for (int n = 0; n < argc; ++n) {
+		if (!boost::filesystem::is_directory(argv[n])) {
+			files.push_back(argv[n]);
+			continue;
+		}
+		boost::filesystem::directory_iterator end;
+		for (boost::filesystem::directory_iterator it(argv[n]); it != end; ++it) {
+			if (boost::filesystem::is_regular_file(it->status())) files.push_back(it->path().string());
+		}
+	}
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc < 4) {
+		printf("Usage: ReducedReadCheck model_file.{xml,yaml,dpm} min_object_size image_file_or_directory [...]\n");
+		exit(-1);
+	}
+
+	// load the model
+	boost::scoped_ptr<Model> model;
+	if (boost::filesystem::path(argv[1]).extension().string() == ".dpm") model.reset(new BinaryModel);
+	else model.reset(new FileStorageModel);
+	if (!model->deserialize(argv[1])) {
+		printf("Error deserializing file\n");
+		exit(-2);
+	}
+	PartsBasedDetector<float> pbd;
+	pbd.distributeModel(*model);
+	const float min_object_size = (float)atof(argv[2]);
+
+	// detect in the full resolution and the reduced image of every image that can be reduced
+	const vector<string> files = imageFiles(argc-3, argv+3);
+	Agreement agreement;
+	int unreduced = 0;
+	double t_full = 0, t_reduced = 0;
+	for (unsigned int n = 0; n < files.size(); ++n) {
+		double t = (double)getTickCount();
+		Mat im = imread(files[n]);
+		if (im.empty()) continue;
+		DetectOptions options(min_object_size, 0);
+		const int denom = pbd.inputReduction(im.size(), options);
+		if (denom == 1) { unreduced++; continue; }
+		vectorCandidate reference, test;
+		pbd.detect(im, Mat(), options, reference);
+		t_full += ((double)getTickCount() - t)/getTickFrequency();
+
+		t = (double)getTickCount();
+		Mat reduced = ReducedImageReader::read(files[n], denom);
+		options.inputScale = 1.0f / denom;
+		pbd.detect(reduced, Mat(), options, test);
+		t_reduced += ((double)getTickCount() - t)/getTickFrequency();
+
+		Candidate::sort(reference);
+		Candidate::sort(test);
+		const int before = agreement.identical;
+		match(reference, test, 0.5, agreement);
+		if (agreement.identical == before) {
+			printf("  %s (1/%d): %d full, %d reduced candidates disagree\n", files[n].c_str(), denom, (int)reference.size(), (int)test.size());
+		}
+	}
+	if (agreement.images == 0) {
+		printf("No readable images the minimum object size allows to reduce\n");
+		exit(-3);
+	}
+
+	// report
+	const int matched = max(agreement.matched, 1);
+	printf("Reduced read check (%d images, %d not reducible):\n", agreement.images, unreduced);
+	printf("  candidates: %d full, %d reduced, %d matched\n", agreement.reference, agreement.test, agreement.matched);
+	printf("  identical images: %d (%.1f%%)\n", agreement.identical, 100.0*agreement.identical/agreement.images);
+	printf("  matched score difference: mean %g, max %g\n", agreement.score_diff/matched, agreement.max_score_diff);
+	printf("  matched box overlap: mean %.3f\n", agreement.iou/matched);
+	printf("  read and detection time: full %.3f s, reduced %.3f s (%.2fx)\n", t_full, t_reduced, t_full/max(t_reduced, 1e-9));
+	return (agreement.identical == agreement.images) ? 0 : 1;
+}
@@ -40,60 +40,279 @@
 #include "Candidate.hpp"
 #include "SearchSpacePruning.hpp"
 #include "Math.hpp"
+#include "DepthSummary.hpp"
+#include <stdint.h>
+#include <cmath>
 #include <limits>
 #include <iostream>
 using namespace cv;
 using namespace std;
 
+/*! @brief select the pyramid levels at which objects fall within a size range
+ *
+ * The height of a component is the extent of its parts (at their anchor
+ * positions, for the first mixture) in feature cells. A level is selected if
+ * any component's height at that level's scale lies within [minsize, maxsize]
+ *
+ * @param parts the tree of parts
+ * @param scales the scales of the pyramid (image pixels per cell at each level)
+ * @param minsize the smallest object height, in image pixels (0 for no limit)
+ * @param maxsize the largest object height, in image pixels (0 for no limit)
+ * @param levels the output selection, one flag per level
+ */
+template<typename T>
+void SearchSpacePruning<T>::selectScalesBySize(Parts& parts, const vectorf& scales, float minsize, float maxsize, vector<bool>& levels) const {
+
+	// the height of each component in cells, from the anchor layout
+	const unsigned int C = parts.ncomponents();
+	vectorf heights(C);
+	for (unsigned int c = 0; c < C; ++c) {
+		const unsigned int P = parts.nparts(c);
+		vectori y(P, 0);
+		int ymin = 0, ymax = 0;
+		for (unsigned int p = 0; p < P; ++p) {
+			ComponentPart part = parts.component(c,p);
+			if (!part.isRoot()) y[p] = y[part.parent().self()] + part.anchor(0).y;
+			ymin = min(ymin, y[p]);
+			ymax = max(ymax, y[p] + (int)part.ysize(0));
+		}
+		heights[c] = ymax - ymin;
+	}
+
+	const unsigned int N = scales.size();
+	levels.assign(N, false);
+	for (unsigned int n = 0; n < N; ++n) {
+		for (unsigned int c = 0; c < C && !levels[n]; ++c) {
+			const float h = heights[c] * scales[n];
+			levels[n] = (minsize <= 0 || h >= minsize) && (maxsize <= 0 || h <= maxsize);
+		}
+	}
+}
+
+/*! @brief select the pyramid levels consistent with the depths in a frame
+ *
+ * The depth histogram of the frame gives the set of depths at which objects
+ * may appear. For every sufficiently populated depth bin [Z0, Z1), a root of
+ * physical width X appears between fx*X/Z1 and fx*X/Z0 pixels wide (widened
+ * by the tolerance). A level is selected if the root width of any component
+ * and mixture at that level falls within the range of any bin
+ *
+ * @param parts the tree of parts
+ * @param depth the depth image (CV_16U in millimeters, or CV_32F/CV_64F in meters)
+ * @param scales the scales of the pyramid (image pixels per cell at each level)
+ * @param levels the output selection, one flag per level. Every level is
+ * selected if there is no depth prior or no valid depth
+ */
+template<typename T>
+void SearchSpacePruning<T>::selectScalesByDepth(Parts& parts, const Mat& depth, const vectorf& scales, vector<bool>& levels) const {
+
+	const unsigned int N = scales.size();
+	levels.assign(N, true);
+	if (!hasDepthPrior() || depth.empty()) return;
+
+	// the depth histogram of the whole frame
+	const DepthSummary summary(depth);
+	vector<int> hist;
+	summary.histogram(Rect(Point(0,0), summary.size()), hist);
+	int total = 0;
+	for (unsigned int b = 0; b < hist.size(); ++b) total += hist[b];
+	if (total == 0) return;
+
+	// ignore bins holding less than 0.1% of the valid measurements
+	const double min_count = 0.001 * total;
+	const double expected = fx_ * X_;
+	const unsigned int C = parts.ncomponents();
+	levels.assign(N, false);
+	for (unsigned int n = 0; n < N; ++n) {
+		for (unsigned int c = 0; c < C && !levels[n]; ++c) {
+			ComponentPart root = parts.component(c);
+			for (unsigned int m = 0; m < root.nmixtures() && !levels[n]; ++m) {
+				const double w = root.xsize(m) * scales[n];
+				for (unsigned int b = 0; b < hist.size() && !levels[n]; ++b) {
+					if (hist[b] < min_count) continue;
+					const double wmin = expected / summary.binUpper(b) * (1.0 - tolerance_);
+					const double wmax = expected / summary.binLower(b) * (1.0 + tolerance_);
+					levels[n] = (w >= wmin && w <= wmax);
+				}
+			}
+		}
+	}
+}
+
+/*! @brief compute masks of the root locations that are plausible given depth
+ *
+ * For each scale and component, a root at feature location (x,y) covers the
+ * same image region as the root bounding box reported by the dynamic program.
+ * The mean valid depth Z over that region implies an expected image width of
+ * fx*X/Z pixels for the root. Locations where the actual root width differs
+ * from this by more than the tolerance (for every mixture of the root) are
+ * masked out. Locations without any valid depth are kept
+ *
+ * @param parts the tree of parts
+ * @param depth the depth image (CV_16U in millimeters, or CV_32F/CV_64F in meters).
+ * It may be of different resolution to the color image
+ * @param imsize the size of the color image
+ * @param fsizes the size of the feature map at each scale, in cells
+ * @param scales the scales (image pixels per cell at each scale)
+ * @param masks the output masks, indexed by [scale][component], of type CV_8U and
+ * of size fsizes[scale]. Nonzero entries are plausible root locations
+ * @return the fraction of root locations which were masked out
+ */
 template<typename T>
-void SearchSpacePruning<T>::filterResponseByDepth(vector2DMat& pdfs, const vector<Size>& fsizes, const Mat& depth, const vectorf& scales, const float X, const float fx) {
+double SearchSpacePruning<T>::filterResponseByDepth(Parts& parts, const Mat& depth, const Size& imsize, const vector<Size>& fsizes, const vectorf& scales, vector2DMat& masks) const {
+
+	const unsigned int N = fsizes.size();
+	const unsigned int C = parts.ncomponents();
+	masks.clear();
+	masks.resize(N, vectorMat(C));
+	if (!hasDepthPrior() || depth.empty()) return 0;
 
-	const unsigned int N  = pdfs.size();
-	const unsigned int F  = pdfs[0].size();
+	// summarize the depth once for all scales
+	const DepthSummary summary(depth);
+	const Point2d s(depth.cols / (double)imsize.width, depth.rows / (double)imsize.height);
+	const double expected = fx_ * X_;
 
+	double total = 0, pruned = 0;
 #ifdef _OPENMP
-	#pragma omp parallel for
+	#pragma omp parallel for reduction(+:total,pruned)
 #endif
-	for (int nf = 0; nf < N*F; ++nf) {
-		const unsigned int n = nf / F;
-		const unsigned int f = nf % F;
-
-		// create a mask of plausible depths given the object size
-		// and the scale of the image
-		Mat sdepth;
-		resize(depth, sdepth, pdfs[n][f].size());
-
-		// calculate the depth of the part in real-world coordinates,
-		// given the 3d width of the part, the focal length of the camera,
-		// and the width of the part in the image
-		float Z = fx*X/scales[n];
-		Z += fsizes[0].height;
+	for (int nc = 0; nc < N*C; ++nc) {
+		const unsigned int n = nc / C;
+		const unsigned int c = nc % C;
+		const double scale = scales[n];
+		ComponentPart root = parts.component(c);
+		const unsigned int nmixtures = root.nmixtures();
+		Mat_<uchar> mask = Mat_<uchar>::zeros(fsizes[n]);
+
+		for (int y = 0; y < mask.rows; ++y) {
+			uchar* mask_ptr = mask[y];
+			for (int x = 0; x < mask.cols; ++x) {
+				for (unsigned int m = 0; m < nmixtures && !mask_ptr[x]; ++m) {
+					// the root bounding box in the depth image
+					const double w = root.xsize(m) * scale;
+					const double h = root.ysize(m) * scale;
+					const Rect r((x-1)*scale*s.x, (y-1)*scale*s.y, w*s.x, h*s.y);
+					const int count = summary.count(r);
+					if (count == 0) { mask_ptr[x] = 1; break; }
+					const double Z = summary.sum(r) / count;
+					const double ratio = expected / (Z * w);
+					mask_ptr[x] = fabs(ratio - 1.0) <= tolerance_;
+				}
+			}
+		}
+		total  += mask.rows * mask.cols;
+		pruned += mask.rows * mask.cols - countNonZero(mask);
+		masks[n][c] = mask;
 	}
+	return (total > 0) ? pruned / total : 0;
 }
 
+/*! @brief compute masks of the root locations whose bounding box touches a region
+ *
+ * For each scale and component, a root at feature location (x,y) covers the
+ * same image region as the root bounding box reported by the dynamic program.
+ * Locations where that box (for any mixture of the root) intersects none of
+ * the regions are masked out, so only objects overlapping the regions are
+ * searched
+ *
+ * @param parts the tree of parts
+ * @param regions the regions to search, in image coordinates
+ * @param fsizes the size of the feature map at each scale, in cells
+ * @param scales the scales (image pixels per cell at each scale)
+ * @param masks the output masks, indexed by [scale][component], of type CV_8U and
+ * of size fsizes[scale]. Nonzero entries are root locations to search
+ * @return the fraction of root locations which were masked out
+ */
+template<typename T>
+double SearchSpacePruning<T>::filterResponseByRegions(Parts& parts, const vector<Rect>& regions, const vector<Size>& fsizes, const vectorf& scales, vector2DMat& masks) const {
+
+	const unsigned int N = fsizes.size();
+	const unsigned int C = parts.ncomponents();
+	masks.clear();
+	masks.resize(N, vectorMat(C));
+
+	double total = 0, pruned = 0;
+	for (unsigned int n = 0; n < N; ++n) {
+		const double scale = scales[n];
+		const Rect bounds(Point(0,0), fsizes[n]);
+		for (unsigned int c = 0; c < C; ++c) {
+			ComponentPart root = parts.component(c);
+			Mat_<uchar> mask = Mat_<uchar>::zeros(fsizes[n]);
+			for (unsigned int m = 0; m < root.nmixtures(); ++m) {
+				const double w = root.xsize(m) * scale;
+				const double h = root.ysize(m) * scale;
+				for (unsigned int r = 0; r < regions.size(); ++r) {
+					// the roots whose box [(x-1)*scale, (x-1)*scale+w) overlaps the region
+					const Point tl(floor((regions[r].x - w) / scale) + 2, floor((regions[r].y - h) / scale) + 2);
+					const Point br(ceil(regions[r].br().x / scale) + 1, ceil(regions[r].br().y / scale) + 1);
+					const Rect roots = Rect(tl, br) & bounds;
+					if (roots.area() > 0) mask(roots) = 1;
+				}
+			}
+			total  += mask.rows * mask.cols;
+			pruned += mask.rows * mask.cols - countNonZero(mask);
+			masks[n][c] = mask;
+		}
+	}
+	return (total > 0) ? pruned / total : 0;
+}
+
+/*! @brief the median depth within a region of a depth image
+ *
+ * @param depth the depth image, of type CV_16U, CV_32F or CV_64F
+ * @param roi the region of interest, clipped to the image bounds
+ * @param fbuf scratch storage for CV_32F depth, reused between calls
+ * @param dbuf scratch storage for CV_64F depth, reused between calls
+ * @return the median depth, or 0 if the region is empty
+ */
+static double medianDepth(const Mat& depth, Rect roi, vector<float>& fbuf, vector<double>& dbuf) {
+	roi &= Rect(Point(0,0), depth.size());
+	if (roi.area() == 0) return 0;
+	switch (depth.depth()) {
+		case CV_16U: return Math::median<uint16_t>(depth(roi));
+		case CV_32F: return Math::median<float>(depth(roi), fbuf);
+		case CV_64F: return Math::median<double>(depth(roi), dbuf);
+		default: CV_Error(CV_StsUnsupportedFormat, "Unsupported depth image type"); return 0;
+	}
+}
+
+/*! @brief remove candidates whose parts are not consistent in depth
+ *
+ * For every child-parent pair of parts, the median depths under the two
+ * part bounding boxes may differ by at most the anchor distance scaled by
+ * zfactor. Parts with no valid depth are not tested
+ *
+ * @param parts the tree of parts
+ * @param candidates the candidates to filter, in place
+ * @param depth the depth image (CV_16U, CV_32F or CV_64F) at the same resolution as the candidates
+ * @param zfactor the depth tolerance per unit of anchor distance
+ */
 template<typename T>
 void SearchSpacePruning<T>::filterCandidatesByDepth(Parts& parts, vectorCandidate& candidates, const Mat& depth, const float zfactor) {
 
 	vectorCandidate new_candidates;
+	vector<float> fbuf;
+	vector<double> dbuf;
 	const unsigned int N = candidates.size();
 	for (unsigned int n = 0; n < N; ++n) {
 		const unsigned int c = candidates[n].component();
-		const unsigned int nparts = parts.nparts(c);
+		const int nparts = parts.nparts(c);
 		const vector<Rect>& boxes = candidates[n].parts();
-		for (unsigned int p = nparts-1; p >= 1; --p) {
+		bool consistent = true;
+		for (int p = nparts-1; p >= 1 && consistent; --p) {
 			ComponentPart part = parts.component(c,p);
 			Point anchor = part.anchor(0);
 			Rect child   = boxes[part.self()];
 			Rect parent  = boxes[part.parent().self()];
-			T cmed_depth = Math::median<T>(depth(child));
-			T pmed_depth = Math::median<T>(depth(parent));
+			double cmed_depth = medianDepth(depth, child, fbuf, dbuf);
+			double pmed_depth = medianDepth(depth, parent, fbuf, dbuf);
 			if (cmed_depth > 0 && pmed_depth > 0) {
-				if (abs(cmed_depth-pmed_depth) > norm(anchor)*zfactor) break;
+				if (fabs(cmed_depth-pmed_depth) > norm(anchor)*zfactor) consistent = false;
 			}
-			if (p == 1) new_candidates.push_back(candidates[n]);
 		}
+		if (consistent) new_candidates.push_back(candidates[n]);
 	}
-	candidates = new_candidates;
+	candidates.swap(new_candidates);
 }
 
 // declare all specializations of the template (this must be the last declaration in the file)
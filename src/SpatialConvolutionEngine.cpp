@@ -52,10 +52,12 @@ void SpatialConvolutionEngine::convolve(const Mat& feature, vectorFilterEngine&
 	Rect roi(0,0,-1,-1); // full image
 	Point offset(0,0);
 	Size fsize = featurev[0].size();
-	pdf = Mat::zeros(fsize, type_);
+	// reuse the output buffer if it is already the right size
+	pdf.create(fsize, type_);
+	pdf = Scalar::all(0);
 
+	Mat pdfc(fsize, type_);
 	for (unsigned int c = 0; c < stride; ++c) {
-		Mat pdfc(fsize, type_);
 		filter[c]->apply(featurev[c], pdfc, roi, offset, true);
 		pdf += pdfc;
 	}
@@ -68,10 +70,12 @@ void SpatialConvolutionEngine::convolve(const Mat& feature, vectorFilterEngine&
  * the feature map. Parts are support vector machines (SVMs) represented as filters.
  * The convolution of a filter with a feature produces a probability density function
  * (pdf) of part location
- * @param features the input features (at different scales, and by extension, size)
- * @param responses the vector of responses (pdfs) to return
+ * @param features the input features (at different scales, and by extension, size).
+ * Empty features produce empty responses
+ * @param responses the vector of responses (pdfs) to return. Responses left over
+ * from a previous call are overwritten in place where their size matches
  */
-void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& responses) {
+void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& responses, const CancellationToken* token) {
 
 	// preallocate the output
 	const unsigned int M = features.size();
@@ -84,11 +88,18 @@ void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& respo
 #endif
 	for (int n = 0; n < N; ++n) {
 		for (unsigned int m = 0; m < M; ++m) {
-			Mat response;
-			convolve(features[m], filters_[n], response, flen_);
-			responses[m][n] = response;
+			// scales pruned from the search space have no features
+			if (features[m].empty() || CancellationToken::isCancelled(token)) {
+				responses[m][n] = Mat();
+				continue;
+			}
+			convolve(features[m], filters_[n], responses[m][n], flen_);
 		}
 	}
+	if (CancellationToken::isCancelled(token)) {
+		responses.clear();
+		CancellationToken::check(token);
+	}
 }
 
 /*! @brief set the filters
@@ -100,16 +111,35 @@ void SpatialConvolutionEngine::pdf(const vectorMat& features, vector2DMat& respo
  */
 void SpatialConvolutionEngine::setFilters(const vectorMat& filters) {
 
+	// split each filter into separate channels
 	const unsigned int N = filters.size();
+	vector2DMat planes(N);
+	for (unsigned int n = 0; n < N; ++n) {
+		split(filters[n].reshape(flen_), planes[n]);
+	}
+	setFilterPlanes(planes);
+}
+
+/*! @brief set the filters from their planes
+ *
+ * given a set of filters already split into flen planes of the engine type
+ * (eg. as returned by filterPlanes() and cached), create a filter engine
+ * for each plane
+ *
+ * @param planes the filter planes, indexed by filter then plane
+ */
+void SpatialConvolutionEngine::setFilterPlanes(const vector2DMat& planes) {
+
+	const unsigned int N = planes.size();
+	planes_ = planes;
 	filters_.clear();
 	filters_.resize(N);
 
-	// split each filter into separate channels, and create a filter engine
 	const unsigned int C = flen_;
 	for (unsigned int n = 0; n < N; ++n) {
-		vectorMat filtervec;
+		const vectorMat& filtervec = planes[n];
+		CV_Assert(filtervec.size() == C);
 		std::vector<Ptr<FilterEngine> > filter_engines(C);
-		split(filters[n].reshape(C), filtervec);
 
 		// the first N-1 filters have zero-padding
 		for (unsigned int m = 0; m < C-1; ++m) {
@@ -125,3 +155,16 @@ void SpatialConvolutionEngine::setFilters(const vectorMat& filters) {
 		filters_[n] = filter_engines;
 	}
 }
+
+/*! @brief create an independent copy of the engine
+ *
+ * FilterEngine objects hold internal row buffers and cannot be shared
+ * between threads, so the copy builds its own from the filter planes
+ *
+ * @return a new engine, owned by the caller
+ */
+IConvolutionEngine* SpatialConvolutionEngine::clone(void) const {
+	SpatialConvolutionEngine* engine = new SpatialConvolutionEngine(type_, flen_);
+	if (!planes_.empty()) engine->setFilterPlanes(planes_);
+	return engine;
+}
@@ -0,0 +1,150 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    UpdatePyramidBenchmark.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "HOGFeatures.hpp"
+#include "types.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief generate a synthetic VGA frame with texture at several scales
+ *
+ * smoothed noise, so that every HOG cell sees a spread of gradient
+ * orientations rather than a flat image
+ */
+static Mat syntheticFrame(RNG& rng) {
+	Mat im(480, 640, CV_8UC3);
+	rng.fill(im, RNG::UNIFORM, 0, 256);
+	GaussianBlur(im, im, Size(0, 0), 2.0);
+	for (int n = 0; n < 12; ++n) {
+		Rect r(rng.uniform(0, 600), rng.uniform(0, 440), rng.uniform(20, 120), rng.uniform(20, 120));
+		im(r & Rect(0, 0, im.cols, im.rows)).setTo(Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)));
+	}
+	return im;
+}
+
+/*! @brief the mask of pixels which differ between two frames in any channel
+ */
+static Mat changedMask(const Mat& a, const Mat& b) {
+	Mat diff, maxdiff;
+	absdiff(a, b, diff);
+	reduce(diff.reshape(1, diff.rows*diff.cols), maxdiff, 1, CV_REDUCE_MAX);
+	return maxdiff.reshape(1, a.rows) != 0;
+}
+
+/*! @brief deep copy a pyramid, so it can be updated in place
+ */
+static vectorMat clonePyramid(const vectorMat& pyramid) {
+	vectorMat copy(pyramid.size());
+	for (unsigned int n = 0; n < pyramid.size(); ++n) copy[n] = pyramid[n].clone();
+	return copy;
+}
+
+int main(int argc, char** argv) {
+
+	// check arguments
+	if (argc > 4) {
+		printf("Usage: UpdatePyramidBenchmark [binsize] [patch_size] [ntrials]\n");
+		exit(-1);
+	}
+	const int binsize = (argc > 1) ? atoi(argv[1]) : 8;
+	int patch         = (argc > 2) ? atoi(argv[2]) : 64;
+	const int N       = (argc > 3) ? atoi(argv[3]) : 20;
+	if (binsize <= 0 || patch <= 0 || N <= 0) {
+		printf("binsize, patch_size and ntrials must be positive\n");
+		exit(-2);
+	}
+
+	HOGFeatures<float> hog(binsize, 5, 32, 18);
+	RNG rng(0xdeadbeef);
+	Mat frame = syntheticFrame(rng);
+	patch = min(patch, min(frame.cols, frame.rows));
+	vectorMat previous;
+	hog.pyramid(frame, previous);
+
+	// change a patch of the frame, then compare a full recomputation with
+	// an update of the previous pyramid
+	double tfull = 0, tupdate = 0, maxdiff = 0;
+	int failures = 0;
+	for (int n = 0; n < N; ++n) {
+		Mat next = frame.clone();
+		const Rect r(rng.uniform(0, frame.cols-patch+1), rng.uniform(0, frame.rows-patch+1), patch, patch);
+		Mat texture(r.size(), CV_8UC3);
+		rng.fill(texture, RNG::UNIFORM, 0, 256);
+		texture.copyTo(next(r));
+		Mat changed = changedMask(frame, next);
+
+		vectorMat reference;
+		double t = (double)getTickCount();
+		hog.pyramid(next, reference);
+		tfull += ((double)getTickCount() - t)/getTickFrequency();
+
+		vectorMat updated = clonePyramid(previous);
+		t = (double)getTickCount();
+		hog.updatePyramid(next, changed, updated);
+		tupdate += ((double)getTickCount() - t)/getTickFrequency();
+
+		bool same = reference.size() == updated.size();
+		for (unsigned int l = 0; same && l < reference.size(); ++l) {
+			if (reference[l].size() != updated[l].size() || reference[l].type() != updated[l].type()) {
+				same = false;
+				break;
+			}
+			const double d = norm(reference[l], updated[l], NORM_INF);
+			maxdiff = std::max(maxdiff, d);
+			if (d != 0) {
+				printf("Trial %d: level %d differs by %g\n", n, l, d);
+				same = false;
+			}
+		}
+		if (!same) failures++;
+		frame = next;
+		previous = reference;
+	}
+
+	printf("Pyramid update of a %dx%d patch in a %dx%d frame (binsize %d, %d trials):\n",
+			patch, patch, frame.cols, frame.rows, binsize, N);
+	printf("  full:    %8.3f ms/frame\n", tfull*1e3/N);
+	printf("  update:  %8.3f ms/frame  (%.1fx)\n", tupdate*1e3/N, tfull/tupdate);
+	printf("  max |difference|: %g  (%s)\n", maxdiff, failures ? "MISMATCH" : "ok");
+	return failures ? 1 : 0;
+}
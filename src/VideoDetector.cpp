@@ -0,0 +1,125 @@
+/* 
+ *  Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2012, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  File:    VideoDetector.cpp
+ *  Created: Oct 19, 2026
+ */
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include "VideoDetector.hpp"
+using namespace cv;
+using namespace std;
+
+/*! @brief find the regions which changed since the previous frame
+ *
+ * The absolute frame difference is thresholded, dilated to join nearby
+ * changes, and the bounding boxes of the connected regions above the
+ * minimum area are returned
+ *
+ * @param gray the current frame, in grayscale
+ * @param changed the output mask of changed pixels (nonzero where changed)
+ * @param regions the output changed regions, in image coordinates
+ */
+template<typename T>
+void VideoDetector<T>::changedRegions(const Mat& gray, Mat& changed, vector<Rect>& regions) const {
+
+	Mat diff;
+	absdiff(gray, previous_, diff);
+	threshold(diff, changed, diff_threshold_, 255, THRESH_BINARY);
+	dilate(changed, changed, getStructuringElement(MORPH_RECT, Size(5,5)), Point(-1,-1), 2);
+
+	// findContours modifies its input
+	Mat contour_mask = changed.clone();
+	vector<vector<Point> > contours;
+	findContours(contour_mask, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+	regions.clear();
+	for (unsigned int n = 0; n < contours.size(); ++n) {
+		Rect r = boundingRect(contours[n]);
+		if (r.area() >= min_region_area_) regions.push_back(r);
+	}
+}
+
+/*! @brief detect objects in the next frame of a video
+ *
+ * @param im the next frame of the video
+ * @param candidates the output vector of detection candidates above the threshold
+ */
+template<typename T>
+void VideoDetector<T>::detect(const Mat& im, vectorCandidate& candidates) {
+
+	Mat gray;
+	if (im.channels() == 3) cvtColor(im, gray, CV_BGR2GRAY);
+	else gray = im.clone();
+
+	keyframe_ = previous_.empty() || previous_.size() != gray.size() || previous_.type() != gray.type() ||
+			keyframe_interval_ <= 1 || frame_ % keyframe_interval_ == 0;
+
+	if (keyframe_) {
+		// compute the pyramid from scratch and search the whole frame
+		detector_.detectUpdate(im, Mat(), vector<Rect>(1, Rect(Point(0,0), im.size())), pyramid_, candidates);
+	} else {
+		Mat changed;
+		vector<Rect> regions;
+		changedRegions(gray, changed, regions);
+
+		// keep the previous candidates which do not touch any change, and
+		// search around those that do (via the changed region they overlap)
+		candidates.clear();
+		for (unsigned int i = 0; i < previous_candidates_.size(); ++i) {
+			const Rect box = previous_candidates_[i].boundingBox();
+			bool moved = false;
+			for (unsigned int n = 0; n < regions.size() && !moved; ++n) moved = (box & regions[n]).area() > 0;
+			if (moved) regions.push_back(box);
+			else candidates.push_back(previous_candidates_[i]);
+		}
+
+		// recompute the features around the changed pixels, reusing the rest
+		// of the previous pyramid, and search only roots touching the regions.
+		// With no regions, the pyramid is still kept up to date
+		vectorCandidate updated;
+		detector_.detectUpdate(im, changed, regions, pyramid_, updated);
+		if (!updated.empty()) {
+			candidates.insert(candidates.end(), updated.begin(), updated.end());
+			Candidate::sort(candidates);
+			Candidate::nonMaximaSuppression(im, candidates, 0.4);
+		}
+	}
+
+	previous_ = gray;
+	previous_candidates_ = candidates;
+	frame_++;
+}
+
+// declare all specializations of the template (this must be the last declaration in the file)
+template class VideoDetector<float>;
+template class VideoDetector<double>;
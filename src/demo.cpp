@@ -45,6 +45,7 @@
 #include "PartsBasedDetector.hpp"
 #include "Candidate.hpp"
 #include "FileStorageModel.hpp"
+#include "BinaryModel.hpp"
 #ifdef WITH_MATLABIO
     #include "MatlabIOModel.hpp"
 #endif
@@ -70,6 +71,9 @@ int main(int argc, char** argv) {
     if (ext.compare(".xml") == 0 || ext.compare(".yaml") == 0) {
         model.reset(new FileStorageModel);
     }
+    else if (ext.compare(".dpm") == 0) {
+        model.reset(new BinaryModel);
+    }
 #ifdef WITH_MATLABIO
     else if (ext.compare(".mat") == 0) {
         model.reset(new MatlabIOModel);
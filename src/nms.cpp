@@ -35,16 +35,172 @@
  *  Author:  Hilton Bristow
  *  Created: Jul 19, 2012
  */
+#include <assert.h>
 #include <stdint.h> 
 #include <stdio.h>
 #include <iostream>
 #include <limits>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "nms.hpp"
 using namespace std;
 using namespace cv;
 
+namespace {
+
+/*! @brief the maximum of a contiguous run of elements
+ *
+ * @param src pointer to the first element
+ * @param N the number of elements
+ * @return the maximum, or -infinity if N == 0
+ */
+template<typename T>
+inline T rowMax(const T* src, const int N) {
+	T v = -numeric_limits<T>::infinity();
+	for (int n = 0; n < N; ++n) if (src[n] > v) v = src[n];
+	return v;
+}
+
+#ifdef __SSE2__
+template<>
+inline float rowMax<float>(const float* src, const int N) {
+	float v = -numeric_limits<float>::infinity();
+	int n = 0;
+	if (N >= 8) {
+		__m128 v0 = _mm_loadu_ps(src);
+		__m128 v1 = _mm_loadu_ps(src+4);
+		for (n = 8; n+8 <= N; n+=8) {
+			v0 = _mm_max_ps(v0, _mm_loadu_ps(src+n));
+			v1 = _mm_max_ps(v1, _mm_loadu_ps(src+n+4));
+		}
+		float lanes[4];
+		_mm_storeu_ps(lanes, _mm_max_ps(v0, v1));
+		for (int k = 0; k < 4; ++k) if (lanes[k] > v) v = lanes[k];
+	}
+	for (; n < N; ++n) if (src[n] > v) v = src[n];
+	return v;
+}
+
+template<>
+inline double rowMax<double>(const double* src, const int N) {
+	double v = -numeric_limits<double>::infinity();
+	int n = 0;
+	if (N >= 4) {
+		__m128d v0 = _mm_loadu_pd(src);
+		__m128d v1 = _mm_loadu_pd(src+2);
+		for (n = 4; n+4 <= N; n+=4) {
+			v0 = _mm_max_pd(v0, _mm_loadu_pd(src+n));
+			v1 = _mm_max_pd(v1, _mm_loadu_pd(src+n+2));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_max_pd(v0, v1));
+		for (int k = 0; k < 2; ++k) if (lanes[k] > v) v = lanes[k];
+	}
+	for (; n < N; ++n) if (src[n] > v) v = src[n];
+	return v;
+}
+#endif
+
+/*! @brief the maximum of a contiguous run of elements, skipping masked elements
+ *
+ * @param src pointer to the first element
+ * @param mask pointer to the first mask element. Zero elements are skipped
+ * @param N the number of elements
+ * @return the maximum, or -infinity if no element is unmasked
+ */
+template<typename T>
+inline T rowMax(const T* src, const uint8_t* mask, const int N) {
+	T v = -numeric_limits<T>::infinity();
+	for (int n = 0; n < N; ++n) if (mask[n] && src[n] > v) v = src[n];
+	return v;
+}
+
+/*! @brief the maximum of the elements [begin, end) of a row, with or without a mask
+ */
+template<typename T>
+inline T rowMax(const T* src, const uint8_t* mask, const int begin, const int end, const bool masked) {
+	return masked ? rowMax<T>(src+begin, mask+begin, end-begin) : rowMax<T>(src+begin, end-begin);
+}
+
+/*! @brief block non-maxima suppression specialized for floating point matrices
+ *
+ * Functionally equivalent to the generic implementation (an empty or fully
+ * masked neighbourhood has a maximum of -infinity in both), but operates directly
+ * on the row pointers rather than through minMaxLoc and block masks. The
+ * neighbourhood of each block candidate is visited as a set of contiguous row
+ * segments on either side of the block, so no per-block mask is allocated and
+ * the search exits as soon as a larger neighbour is found. Rows of blocks are
+ * processed in parallel via OpenMP
+ *
+ * @param src the single channel input matrix
+ * @param sz the size of the window
+ * @param dst the CV_8U output mask, preallocated to src.size() and zeroed
+ * @param mask an optional CV_8U mask of elements to consider
+ */
+template<typename T>
+void nonMaximaSuppressionBlocks(const Mat& src, const int sz, Mat& dst, const Mat& mask) {
+
+	const int M = src.rows;
+	const int N = src.cols;
+	const int step = sz+1;
+	const int nblockrows = (M + sz) / step;
+	const bool masked = !mask.empty();
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+	#endif
+	for (int b = 0; b < nblockrows; ++b) {
+		const int ic0 = b*step;
+		const int ic1 = std::min(ic0+step, M);
+		for (int jc0 = 0; jc0 < N; jc0 += step) {
+			const int jc1 = std::min(jc0+step, N);
+
+			// get the maximal candidate within the block
+			T vcmax = -numeric_limits<T>::infinity();
+			int cy = -1, cx = -1;
+			for (int i = ic0; i < ic1; ++i) {
+				const T* src_ptr = src.ptr<T>(i);
+				const uint8_t* mask_ptr = masked ? mask.ptr<uint8_t>(i) : NULL;
+				if (rowMax<T>(src_ptr, mask_ptr, jc0, jc1, masked) <= vcmax) continue;
+				for (int j = jc0; j < jc1; ++j) {
+					if ((!masked || mask_ptr[j]) && src_ptr[j] > vcmax) { vcmax = src_ptr[j]; cy = i; cx = j; }
+				}
+			}
+			if (cy < 0) continue;
+
+			// search the neighbours centered around the candidate for a larger value,
+			// skipping the block whose maxima we already know
+			const int in0 = std::max(cy-sz, 0), in1 = std::min(cy+sz+1, M);
+			const int jn0 = std::max(cx-sz, 0), jn1 = std::min(cx+sz+1, N);
+			bool maximal = true;
+			for (int i = in0; i < in1 && maximal; ++i) {
+				const T* src_ptr = src.ptr<T>(i);
+				const uint8_t* mask_ptr = masked ? mask.ptr<uint8_t>(i) : NULL;
+				T vnmax;
+				if (i >= ic0 && i < ic1) {
+					vnmax = std::max(rowMax<T>(src_ptr, mask_ptr, jn0, jc0, masked),
+									 rowMax<T>(src_ptr, mask_ptr, jc1, jn1, masked));
+				} else {
+					vnmax = rowMax<T>(src_ptr, mask_ptr, jn0, jn1, masked);
+				}
+				if (vnmax >= vcmax) maximal = false;
+			}
+
+			// if the block centre is also the neighbour centre, then it's a local maxima
+			if (maximal) dst.at<uint8_t>(cy, cx) = 255;
+		}
+	}
+}
+
+} // anonymous namespace
+
+
 /*! @brief suppress non-maximal values
  *
  * nonMaximaSuppression produces a mask (dst) such that every non-zero
@@ -81,6 +237,11 @@ using namespace cv;
  * 	random.setTo(0, maxima == 0);
  * \endcode
  *
+ * Single channel float and double matrices (such as the root scores produced
+ * by the DynamicProgram) take a fast path which processes rows of blocks in
+ * parallel and vectorizes the neighbourhood search. All other types fall
+ * back to the generic implementation
+ *
  * @param src the input image/matrix, of any valid cv type
  * @param sz the size of the window
  * @param dst the mask of type CV_8U, where non-zero elements correspond to
@@ -89,6 +250,15 @@ using namespace cv;
  */
 void nonMaximaSuppression(const Mat& src, const int sz, Mat& dst, const Mat mask) {
 
+	// dispatch to the floating point fast path
+	assert(mask.empty() || (mask.type() == CV_8U && mask.size() == src.size()));
+	if (src.channels() == 1 && (src.depth() == CV_32F || src.depth() == CV_64F)) {
+		dst = Mat_<uint8_t>::zeros(src.size());
+		if (src.depth() == CV_32F) nonMaximaSuppressionBlocks<float>(src, sz, dst, mask);
+		if (src.depth() == CV_64F) nonMaximaSuppressionBlocks<double>(src, sz, dst, mask);
+		return;
+	}
+
 	// initialise the block mask and destination
 	const unsigned int M = src.rows;
 	const unsigned int N = src.cols;
@@ -106,6 +276,7 @@ void nonMaximaSuppression(const Mat& src, const int sz, Mat& dst, const Mat mask
 			Range ic(m, min(m+sz+1,M));
 			Range jc(n, min(n+sz+1,N));
 			minMaxLoc(src(ic,jc), NULL, &vcmax, NULL, &ijmax, masked ? mask(ic,jc) : noArray());
+			if (ijmax.x < 0) continue;
 			Point cc = ijmax + Point(jc.start,ic.start);
 
 			// search the neighbours centered around the candidate for the true maxima
@@ -122,6 +293,10 @@ void nonMaximaSuppression(const Mat& src, const int sz, Mat& dst, const Mat mask
 			minMaxLoc(src(in,jn), NULL, &vnmax, NULL, &ijmax, masked ? mask(in,jn).mul(blockmask) : blockmask);
 			//Point cn = ijmax + Point(jn.start, in.start);
 
+			// minMaxLoc reports 0 when every neighbour is masked, so use the
+			// same -infinity sentinel as the fast path (scores are often negative)
+			if (ijmax.x < 0) vnmax = -numeric_limits<double>::infinity();
+
 			// if the block centre is also the neighbour centre, then it's a local maxima
 			if (vcmax > vnmax) {
 				dst.at<uint8_t>(cc.y, cc.x) = 255;